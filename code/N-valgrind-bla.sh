@@ -1,8 +1,25 @@
 #!/bin/bash
 
+#BLAS provider: mkl (default), openblas, blis, reference or builtin (e.g. BLAS=openblas ./N-valgrind-bla.sh)
+blas="${BLAS:-mkl}"
 mkl_root="/opt/intel/mkl"
-blas_flags="-DMKL_ILP64 -m64 -I$mkl_root/include"
-blas_libs="-Wl,--start-group $mkl_root/lib/intel64/libmkl_intel_ilp64.a $mkl_root/lib/intel64/libmkl_sequential.a $mkl_root/lib/intel64/libmkl_core.a -Wl,--end-group -lpthread -ldl"
+case "$blas" in
+    mkl)
+        blas_flags="-DBW_BLAS_MKL -DMKL_ILP64 -m64 -I$mkl_root/include"
+        blas_libs="-Wl,--start-group $mkl_root/lib/intel64/libmkl_intel_ilp64.a $mkl_root/lib/intel64/libmkl_sequential.a $mkl_root/lib/intel64/libmkl_core.a -Wl,--end-group -lpthread -ldl";;
+    openblas)
+        blas_flags="-DBW_BLAS_CBLAS"
+        blas_libs="-lopenblas";;
+    blis)
+        blas_flags="-DBW_BLAS_CBLAS -I/usr/include/blis"
+        blas_libs="-lblis -lpthread";;
+    reference)
+        blas_flags="-DBW_BLAS_CBLAS"
+        blas_libs="-lblas";;
+    *)
+        blas_flags="-DBW_BLAS_BUILTIN"
+        blas_libs="bw-cblas.c";;
+esac
 files=( "bla" )
 compilers=( "g" "i" )
 flags=( "-O2" )
@@ -12,14 +12,14 @@ do
     do
         for flag in "${flags[@]}"
             do
-	        "$compiler"cc $flag -o cache "bw-$file-cg.c" io.c bw-tested.c util.c -lm
+	        "$compiler"cc $flag -o cache "bw-$file.c" io.c bw-tested.c util.c -lm
             for seed in "${seeds[@]}"
             do
                 for N in "${Ns[@]}"
                 do
                     valgrind --tool=cachegrind --cachegrind-out-file="../valgrind/$now-$file-$N-cache" --cache-sim=yes --branch-sim=yes ./cache $seed $N $N $(( N * N )) > bin.txt
                     echo "DAS SEI UESI PARAMETER" "FILE" "$file" "FLAG" "$compiler$flag" "SEED" $seed "N" $N >> "../output_measures/$now-cache.txt"
-                    pcregrep -Mo "fn=bw.*[\n]+([^\n\r]+)" ../valgrind/$now-$file-$N-cache | grep "[0-9].*" >> "../output_measures/$now-cache.txt"
+                    pcregrep -Mo "fn=(train|forward|backward|update|baum_welch|initial_step|final_scaling).*[\n]+([^\n\r]+)" ../valgrind/$now-$file-$N-cache | grep "[0-9].*" >> "../output_measures/$now-cache.txt"
                     echo `date +%m-%d.%H:%M:%S`
                     echo "$file $compiler$flag $seed $N"
                 done
@@ -40,14 +40,14 @@ do
     do
         for flag in "${flags[@]}"
             do
-	        "$compiler"cc $flag -o cache "bw-$file-cg.c" io.c bw-tested.c util.c -lm
+	        "$compiler"cc $flag -o cache "bw-$file.c" io.c bw-tested.c util.c -lm
             for seed in "${seeds[@]}"
             do
                 for N in "${Ns[@]}"
                 do
                     valgrind --tool=cachegrind --cachegrind-out-file="../valgrind/$now-$file-$N-cache" --cache-sim=yes --branch-sim=yes ./cache $seed $N $N $(( N * N )) > bin.txt
                     echo "DAS SEI UESI PARAMETER" "FILE" "$file" "FLAG" "$compiler$flag" "SEED" $seed "N" $N >> "../output_measures/$now-cache.txt"
-                    pcregrep -Mo "fn=bw.*[\n]+([^\n\r]+)" ../valgrind/$now-$file-$N-cache | grep "[0-9].*" >> "../output_measures/$now-cache.txt"
+                    pcregrep -Mo "fn=(train|forward|backward|update|baum_welch|initial_step|final_scaling).*[\n]+([^\n\r]+)" ../valgrind/$now-$file-$N-cache | grep "[0-9].*" >> "../output_measures/$now-cache.txt"
                     echo `date +%m-%d.%H:%M:%S`
                     echo "$file $compiler$flag $seed $N"
                 done
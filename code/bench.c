@@ -0,0 +1,543 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "tested.h"
+#include "util.h"
+#include "bench.h"
+
+#define DELTA 1e-2
+#define BUFSIZE 1<<26
+#define MAX_POINTS 256
+#define MAX_RUNS 1024
+#define MIN_RUNS 3
+#define RESAMPLES 1000
+
+//cost models of one EM step per phase (documents/flops.pdf and documents/memory_accesses.pdf)
+//flops count every add, mult, div, log and compare as one, bytes are the reads and writes of the model times 8 (doubles)
+//stb, cop and umdhmm do the textbook algorithm, reo, vec and bla the reordered one, where the update phase is the pre-forward part,
+//transpose holds both transposes and ab and backward the fused backward and update step (bla has no transpose phase, its share
+//runs inside the other phases, like the convergence check inside the update of stb, only the row all adds up)
+static void baseCost(const double N, const double K, const double T, double* const flops, double* const bytes){
+	flops[PHASE_TRANSPOSE] = 0;
+	flops[PHASE_FORWARD] = 2*N*N*T + 3*N*T + 3*N + T + 1;
+	flops[PHASE_BACKWARD] = 3*(T-1)*N*N + (T-1)*N;
+	flops[PHASE_UPDATE] = 5*T*N*N + 3*T*K*N + T*N + N + N*N + N*K;
+	flops[PHASE_FINISHED] = 2*T + 2;
+
+	bytes[PHASE_TRANSPOSE] = 0;
+	bytes[PHASE_FORWARD] = 8*((4*N + 1 + 2*N*N*T + 2*N*T + T) + (2 + 3*N + 2*T + N*N*T + 4*N*T));
+	bytes[PHASE_BACKWARD] = 8*((N + 3*N*N*(T-1) + N*(T-1)) + (N + 2*N*(T-1) + N*N*(T-1)));
+	bytes[PHASE_UPDATE] = 8*((2*T*N + 4*(T-1)*N*N + 2*N + 2*T*N*N + 2*T*K*N) + (T*N + (T-1)*N*N + N + N*N + N*K));
+	bytes[PHASE_FINISHED] = 8*T;
+}
+
+static void reoCost(const double N, const double K, const double T, double* const flops, double* const bytes){
+	flops[PHASE_TRANSPOSE] = K*N*N;
+	flops[PHASE_FORWARD] = 2*N*N*T + 3*N*T + 6*N + T - 2;
+	flops[PHASE_BACKWARD] = 4*N*N*T - 4*N*N + 4*N*T - 4*N;
+	flops[PHASE_UPDATE] = 2*N + 2*K*N;
+	flops[PHASE_FINISHED] = 2*T;
+
+	bytes[PHASE_TRANSPOSE] = 8*((2*N*N + 2*K*N*N) + (2*N*N + K*N*N));
+	bytes[PHASE_FORWARD] = 8*((2*N*N*T + N*N + 2*N*T + 3*N + T - 3) + (2*N*N + 2*N*T + 4*N + T - 3));
+	bytes[PHASE_BACKWARD] = 8*((3*N*N*T - 3*N*N + 3*N*T - 3*N + 2*T - 2) + (N*N*T - N*N + 4*N*T - 3*N));
+	bytes[PHASE_UPDATE] = 8*((2*N + 2*K*N) + (3*N + 2*K*N));
+	bytes[PHASE_FINISHED] = 8*T;
+}
+
+typedef struct {
+	const variant* v;
+	void (*cost)(const double N, const double K, const double T, double* const flops, double* const bytes);
+} entry;
+
+//all variants the driver knows, -v picks some of them by name
+static const entry registry[] = {
+	{&bench_stb, baseCost},
+	{&bench_cop, baseCost},
+	{&bench_reo, reoCost},
+	{&bench_vec, reoCost},
+	{&bench_bla, reoCost},
+	{&bench_umdhmm, baseCost},
+};
+
+#define VARIANTS (int)(sizeof(registry)/sizeof(registry[0]))
+
+static void usage(const char* name){
+	printf("USAGE: %s [-v stb,cop,...] [-s seeds] [-N Ns] [-K Ks] [-T Ts] [-p N:K:T,...] [-e exp] [-r runs] [-c] [-m cold|warm] [-b seconds] [-f csv|json] [-o file] \n", name);
+	printf("  -N, -K and -T are comma separated lists, the sweep is their cartesian product (K = N and T = N*N if not given) \n");
+	printf("  -p adds single points, -e sets EPSILON to 10^-exp, -r overrides the number of runs per point \n");
+	printf("  -c checks every variant against tested_implementation \n");
+	printf("  -m cold (default) flushes the cache before every run, -m warm does one untimed run first and never flushes \n");
+	printf("  -b $seconds keeps running each variant and point until the budget is used up (at most %d runs) \n", MAX_RUNS);
+}
+
+//comma separated list of positive integers, returns how many were read
+static int parseList(const char* arg, int* const list, const int max){
+
+	int count = 0;
+	const char* next = arg;
+
+	while(*next != '\0' && count < max){
+		char* end;
+		long value = strtol(next, &end, 10);
+
+		if(end == next || value <= 0){
+			printf("Not a list of positive numbers: %s \n", arg);
+			exit(-1);
+		}
+
+		list[count++] = (int) value;
+		next = *end == ',' ? end + 1 : end;
+	}
+
+	return count;
+}
+
+//N:K:T triples separated by commas, appended to the points
+static int parsePoints(const char* arg, int (*const points)[3], int count){
+
+	const char* next = arg;
+
+	while(*next != '\0' && count < MAX_POINTS){
+		int read = 0;
+
+		if(sscanf(next, "%d:%d:%d%n", &points[count][0], &points[count][1], &points[count][2], &read) != 3){
+			printf("Not a list of N:K:T points: %s \n", arg);
+			exit(-1);
+		}
+
+		count++;
+		next += read;
+		next = *next == ',' ? next + 1 : next;
+	}
+
+	return count;
+}
+
+static void writeHeader(FILE* out, const int json){
+	if(json){
+		fprintf(out, "[\n");
+	}else{
+		fprintf(out, "variant,seed,N,K,T,phase,runs,steps,calls,cycles,min_cycles,ci_low,ci_high,flops,flops_per_cycle,bytes,bytes_per_cycle,intensity");
+		for(int c = 0; c < COUNTER_COUNT; c++){
+			fprintf(out, ",%s", counterNames[c]);
+		}
+		fprintf(out, ",check\n");
+	}
+}
+
+//one row per variant and point (phase all) and with -DPHASES one more per phase
+//cycles (median), calls, flops, bytes and counters are per EM step, intensity is flops per byte (the point on the roofline)
+//spread is the minimum and the confidence interval of the median of bootstrap (NULL for the phases, they are means)
+//flops and bytes <= 0 are unknown and spread or counters NULL not measured (empty in CSV, null in JSON)
+static void writeRow(FILE* out, const int json, const int first, const char* name, const problem* const pb, const char* phaseName, const int runs, const int steps, const double calls, const double cycles, const double* const spread, const double flops, const double bytes, const double* const counters, const char* check){
+	if(json){
+		fprintf(out, "%s  {\"variant\": \"%s\", \"seed\": %d, \"N\": %d, \"K\": %d, \"T\": %d, \"phase\": \"%s\", \"runs\": %d, \"steps\": %d, \"calls\": %lf, \"cycles\": %.0lf, ",
+			first ? "" : ",\n", name, pb->seed, pb->N, pb->K, pb->T, phaseName, runs, steps, calls, cycles);
+		if(spread != NULL){
+			fprintf(out, "\"min_cycles\": %.0lf, \"ci_low\": %.0lf, \"ci_high\": %.0lf, ", spread[0], spread[1], spread[2]);
+		}else{
+			fprintf(out, "\"min_cycles\": null, \"ci_low\": null, \"ci_high\": null, ");
+		}
+		if(flops > 0){
+			fprintf(out, "\"flops\": %.0lf, \"flops_per_cycle\": %lf, ", flops, flops/cycles);
+		}else{
+			fprintf(out, "\"flops\": null, \"flops_per_cycle\": null, ");
+		}
+		if(bytes > 0){
+			fprintf(out, "\"bytes\": %.0lf, \"bytes_per_cycle\": %lf, ", bytes, bytes/cycles);
+		}else{
+			fprintf(out, "\"bytes\": null, \"bytes_per_cycle\": null, ");
+		}
+		if(flops > 0 && bytes > 0){
+			fprintf(out, "\"intensity\": %lf, ", flops/bytes);
+		}else{
+			fprintf(out, "\"intensity\": null, ");
+		}
+		for(int c = 0; c < COUNTER_COUNT; c++){
+			if(counters != NULL && counterAvailable(c)){
+				fprintf(out, "\"%s\": %.0lf, ", counterNames[c], counters[c]);
+			}else{
+				fprintf(out, "\"%s\": null, ", counterNames[c]);
+			}
+		}
+		fprintf(out, "\"check\": \"%s\"}", check);
+	}else{
+		fprintf(out, "%s,%d,%d,%d,%d,%s,%d,%d,%lf,%.0lf,", name, pb->seed, pb->N, pb->K, pb->T, phaseName, runs, steps, calls, cycles);
+		if(spread != NULL){
+			fprintf(out, "%.0lf,%.0lf,%.0lf,", spread[0], spread[1], spread[2]);
+		}else{
+			fprintf(out, ",,,");
+		}
+		if(flops > 0){
+			fprintf(out, "%.0lf,%lf,", flops, flops/cycles);
+		}else{
+			fprintf(out, ",,");
+		}
+		if(bytes > 0){
+			fprintf(out, "%.0lf,%lf,", bytes, bytes/cycles);
+		}else{
+			fprintf(out, ",,");
+		}
+		if(flops > 0 && bytes > 0){
+			fprintf(out, "%lf,", flops/bytes);
+		}else{
+			fprintf(out, ",");
+		}
+		for(int c = 0; c < COUNTER_COUNT; c++){
+			if(counters != NULL && counterAvailable(c)){
+				fprintf(out, "%.0lf,", counters[c]);
+			}else{
+				fprintf(out, ",");
+			}
+		}
+		fprintf(out, "%s\n", check);
+	}
+}
+
+//small generator of its own for the bootstrap, so that rand() of the data generation is not touched
+static unsigned long long nextRandom(unsigned long long* const state){
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+//spread of the cycles per step of the runs (sorted): minimum and the 95% bootstrap confidence interval of the median
+static void bootstrap(const double* const runs, const int count, double* const spread){
+
+	double medians[RESAMPLES];
+	double sample[MAX_RUNS];
+	unsigned long long state = 0x9e3779b97f4a7c15ULL;
+
+	for(int r = 0; r < RESAMPLES; r++){
+		for(int i = 0; i < count; i++){
+			sample[i] = runs[nextRandom(&state) % count];
+		}
+		qsort(sample, count, sizeof(double), compare_doubles);
+		medians[r] = sample[count/2];
+	}
+
+	qsort(medians, RESAMPLES, sizeof(double), compare_doubles);
+	spread[0] = runs[0];
+	spread[1] = medians[RESAMPLES/40];
+	spread[2] = medians[RESAMPLES - 1 - RESAMPLES/40];
+}
+
+static double seconds(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+static void writeFooter(FILE* out, const int json){
+	if(json){
+		fprintf(out, "\n]\n");
+	}
+}
+
+int main(int argc, char *argv[]){
+
+	int selected[VARIANTS];
+	int seeds[MAX_POINTS] = {36};
+	int Ns[MAX_POINTS] = {16};
+	int Ks[MAX_POINTS];
+	int Ts[MAX_POINTS];
+	int points[MAX_POINTS][3];
+	int seedCount = 1, NCount = 1, KCount = 0, TCount = 0, pointCount = 0, lists = 0;
+	int fixedRuns = 0, check = 0, json = 0, warm = 0;
+	double budget = 0.0;
+	double epsilon = 1e-4;
+	FILE* out = stdout;
+	int c;
+
+	for(int i = 0; i < VARIANTS; i++){
+		selected[i] = 1;
+	}
+
+	while((c = getopt(argc, argv, "v:s:N:K:T:p:e:r:cm:b:f:o:h")) != -1){
+		switch(c){
+		case 'v':
+			for(int i = 0; i < VARIANTS; i++){
+				selected[i] = 0;
+			}
+			for(char* name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")){
+				int found = 0;
+				for(int i = 0; i < VARIANTS; i++){
+					if(strcmp(name, registry[i].v->name) == 0){
+						selected[i] = found = 1;
+					}
+				}
+				if(!found){
+					printf("Unknown variant %s \n", name);
+					return -1;
+				}
+			}
+			break;
+		case 's':
+			seedCount = parseList(optarg, seeds, MAX_POINTS);
+			break;
+		case 'N':
+			NCount = parseList(optarg, Ns, MAX_POINTS);
+			lists = 1;
+			break;
+		case 'K':
+			KCount = parseList(optarg, Ks, MAX_POINTS);
+			lists = 1;
+			break;
+		case 'T':
+			TCount = parseList(optarg, Ts, MAX_POINTS);
+			lists = 1;
+			break;
+		case 'p':
+			pointCount = parsePoints(optarg, points, pointCount);
+			break;
+		case 'e':
+			epsilon = pow(10, -atoi(optarg));
+			break;
+		case 'r':
+			fixedRuns = atoi(optarg);
+			break;
+		case 'c':
+			check = 1;
+			break;
+		case 'm':
+			if(strcmp(optarg, "warm") != 0 && strcmp(optarg, "cold") != 0){
+				printf("Cache mode is cold or warm, not %s \n", optarg);
+				usage(argv[0]);
+				return -1;
+			}
+			warm = strcmp(optarg, "warm") == 0;
+			break;
+		case 'b':
+			budget = atof(optarg);
+			break;
+		case 'f':
+			if(strcmp(optarg, "csv") != 0 && strcmp(optarg, "json") != 0){
+				printf("Format is csv or json, not %s \n", optarg);
+				usage(argv[0]);
+				return -1;
+			}
+			json = strcmp(optarg, "json") == 0;
+			break;
+		case 'o':
+			out = fopen(optarg, "w");
+			if(out == NULL){
+				printf("Can not write %s \n", optarg);
+				return -1;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+
+	//the sweep comes after the single points, with only -p there is no sweep
+	if(lists || pointCount == 0){
+		for(int n = 0; n < NCount; n++){
+			for(int k = 0; k < (KCount ? KCount : 1); k++){
+				for(int t = 0; t < (TCount ? TCount : 1); t++){
+					if(pointCount == MAX_POINTS){
+						printf("More than %d points \n", MAX_POINTS);
+						return -1;
+					}
+					points[pointCount][0] = Ns[n];
+					points[pointCount][1] = KCount ? Ks[k] : Ns[n];
+					points[pointCount][2] = TCount ? Ts[t] : Ns[n]*Ns[n];
+					pointCount++;
+				}
+			}
+		}
+	}
+
+	//open the counters before the first timed run, without them the columns stay empty
+#ifdef COUNTERS
+	const int counting = openCounters() > 0;
+#else
+	const int counting = 0;
+#endif
+
+	//matrix for flushing cache
+	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
+
+	writeHeader(out, json);
+	int first = 1;
+
+	for(int s = 0; s < seedCount; s++){
+		for(int point = 0; point < pointCount; point++){
+
+			const int seed = seeds[s];
+			const int hiddenStates = points[point][0];
+			const int differentObservables = points[point][1];
+			const int T = points[point][2];
+
+			//same heuristics as the main of every variant, but at least MIN_RUNS runs for the median and its interval
+			int minima=10;
+			int variableSteps=100-cbrt(hiddenStates*differentObservables*T)/3;
+			int maxSteps=minima < variableSteps ? variableSteps : minima;
+			minima=MIN_RUNS;
+			variableSteps=10-log10(hiddenStates*differentObservables*T);
+			int maxRuns=minima < variableSteps ? variableSteps : minima;
+			maxRuns = fixedRuns > 0 ? fixedRuns : maxRuns;
+			maxRuns = maxRuns < MAX_RUNS ? maxRuns : MAX_RUNS;
+			double runs[MAX_RUNS];
+
+			//the same data as ./$variant $seed $hiddenStates $differentObservables $T, generated once for all variants
+			srand(seed);
+
+			double* groundTransitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+			double* groundEmissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+			makeMatrix(hiddenStates, hiddenStates, groundTransitionMatrix);
+			makeMatrix(hiddenStates, differentObservables, groundEmissionMatrix);
+			int groundInitialState = rand()%hiddenStates;
+			int* observations = (int*) malloc ( T * sizeof(int));
+			makeObservations(hiddenStates, differentObservables, groundInitialState, groundTransitionMatrix,groundEmissionMatrix,T, observations);
+
+			double* transitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+			double* emissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+			double* stateProb  = (double*) malloc(hiddenStates * sizeof(double));
+			makeMatrix(hiddenStates, hiddenStates, transitionMatrix);
+			makeMatrix(hiddenStates, differentObservables, emissionMatrix);
+			makeProbabilities(stateProb,hiddenStates);
+
+			problem pb = {seed, hiddenStates, differentObservables, T, maxSteps, epsilon, observations, transitionMatrix, emissionMatrix, stateProb, buf, warm ? 0 : BUFSIZE};
+
+			measurement m;
+			m.transitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+			m.emissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+			m.stateProb  = (double*) malloc(hiddenStates * sizeof(double));
+
+			double* transitionMatrixTesting = NULL;
+			double* emissionMatrixTesting = NULL;
+			double* stateProbTesting = NULL;
+
+			if(check){
+				transitionMatrixTesting = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+				emissionMatrixTesting = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+				stateProbTesting = (double*) malloc(hiddenStates * sizeof(double));
+				memcpy(transitionMatrixTesting, transitionMatrix, hiddenStates*hiddenStates*sizeof(double));
+				memcpy(emissionMatrixTesting, emissionMatrix, hiddenStates*differentObservables*sizeof(double));
+				memcpy(stateProbTesting, stateProb, hiddenStates * sizeof(double));
+				tested_implementation(hiddenStates, differentObservables, T, transitionMatrixTesting, emissionMatrixTesting, stateProbTesting, observations, epsilon, DELTA);
+			}
+
+			for(int i = 0; i < VARIANTS; i++){
+
+				const variant* v = registry[i].v;
+
+				if(!selected[i] || hiddenStates % v->multiple != 0 || differentObservables % v->multiple != 0){
+					continue;
+				}
+
+				fprintf(stderr, "%s %d %d %d %d \n", v->name, seed, hiddenStates, differentObservables, T);
+
+				//the phases of all runs together
+				phase phases[PHASE_COUNT];
+				long totalSteps = 0;
+				resetPhases(phases);
+
+				//warm cache: one run that is not measured instead of the flush (heatup of the mains)
+				if(warm){
+					v->run(&pb, &m);
+				}
+
+				//at least maxRuns runs, then more until the budget is used up
+				const double begin = seconds();
+				int count;
+
+				for(count = 0; count < maxRuns || (budget > 0 && count < MAX_RUNS && seconds() - begin < budget); count++){
+					resetPhases(m.phases);
+					v->run(&pb, &m);
+					runs[count] = (double) m.cycles / m.steps;
+					totalSteps += m.steps;
+
+					for(int p = 0; p < PHASE_COUNT; p++){
+						phases[p].cycles += m.phases[p].cycles;
+						phases[p].calls += m.phases[p].calls;
+
+						for(int c = 0; c < COUNTER_COUNT; c++){
+							phases[p].counters[c] += m.phases[p].counters[c];
+						}
+					}
+				}
+
+				qsort(runs, count, sizeof(double), compare_doubles);
+				double medianTime = runs[count/2];
+				double spread[3];
+				bootstrap(runs, count, spread);
+
+				const char* result = "-";
+				if(check && v->checked){
+					result = similar(transitionMatrixTesting, m.transitionMatrix, hiddenStates, hiddenStates, DELTA)
+						&& similar(emissionMatrixTesting, m.emissionMatrix, hiddenStates, differentObservables, DELTA) ? "ok" : "fail";
+				}
+
+				//model per phase, the whole step is the sum of its phases
+				double flops[PHASE_COUNT], bytes[PHASE_COUNT];
+				double stepFlops = 0.0, stepBytes = 0.0;
+				registry[i].cost(hiddenStates, differentObservables, T, flops, bytes);
+
+				for(int p = 0; p < PHASE_COUNT; p++){
+					stepFlops += flops[p];
+					stepBytes += bytes[p];
+				}
+
+				//counters per step, the whole step is the sum of its phases (umdhmm has none, so nothing was counted)
+				double counters[PHASE_COUNT + 1][COUNTER_COUNT];
+				int counted = 0;
+
+				for(int p = 0; p < PHASE_COUNT; p++){
+					counted |= counting && phases[p].calls > 0;
+				}
+
+				for(int c = 0; c < COUNTER_COUNT; c++){
+					counters[PHASE_COUNT][c] = 0.0;
+
+					for(int p = 0; p < PHASE_COUNT; p++){
+						counters[p][c] = (double)phases[p].counters[c]/totalSteps;
+						counters[PHASE_COUNT][c] += counters[p][c];
+					}
+				}
+
+				writeRow(out, json, first, v->name, &pb, "all", count, m.steps, 1.0, medianTime, spread, stepFlops, stepBytes, counted ? counters[PHASE_COUNT] : NULL, result);
+				first = 0;
+
+				for(int p = 0; p < PHASE_COUNT; p++){
+					if(phases[p].calls > 0){
+						writeRow(out, json, first, v->name, &pb, phaseNames[p], count, m.steps, (double)phases[p].calls/totalSteps, (double)phases[p].cycles/totalSteps, NULL, flops[p], bytes[p], counted ? counters[p] : NULL, result);
+					}
+				}
+
+				fflush(out);
+			}
+
+			free(groundTransitionMatrix);
+			free(groundEmissionMatrix);
+			free(observations);
+			free(transitionMatrix);
+			free(emissionMatrix);
+			free(stateProb);
+			free(m.transitionMatrix);
+			free(m.emissionMatrix);
+			free(m.stateProb);
+			free(transitionMatrixTesting);
+			free(emissionMatrixTesting);
+			free(stateProbTesting);
+		}
+	}
+
+	writeFooter(out, json);
+
+	if(out != stdout){
+		fclose(out);
+	}
+
+	free((void*)buf);
+
+	return 0;
+}
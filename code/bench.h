@@ -0,0 +1,49 @@
+#ifndef BENCH_FILE_
+#define BENCH_FILE_
+
+#include "util.h"
+
+//one point of a sweep of the benchmark driver (bench.c), shared by all variants
+//transitionMatrix is N x N, emissionMatrix N x K (state major like makeMatrix), stateProb N
+typedef struct {
+	int seed;
+	int N;
+	int K;
+	int T;
+	int maxSteps;
+	double epsilon;
+	const int* observations;
+	const double* transitionMatrix;
+	const double* emissionMatrix;
+	const double* stateProb;
+	volatile unsigned char* buf;	//flushed before the timed part
+	int bufsize;
+} problem;
+
+//one run of a variant: cycles of the timed part, EM steps done, the trained model in the layout of the problem and its phases
+typedef struct {
+	unsigned long long cycles;
+	int steps;
+	double* transitionMatrix;
+	double* emissionMatrix;
+	double* stateProb;
+	phase phases[PHASE_COUNT];	//cycles and calls per phase, zero without -DPHASES
+} measurement;
+
+typedef struct {
+	const char* name;
+	int multiple;	//N and K have to be multiples of it
+	int checked;	//trains the same model as tested_implementation (umdhmm smoothes the model)
+	void (*run)(const problem* const pb, measurement* const m);
+} variant;
+
+//the variants, each bw-$name.c defines its own next to its main
+//(their objects keep only this symbol global, see the Makefile)
+extern const variant bench_stb;
+extern const variant bench_cop;
+extern const variant bench_reo;
+extern const variant bench_vec;
+extern const variant bench_bla;
+extern const variant bench_umdhmm;
+
+#endif
@@ -8,369 +8,210 @@
 #include "io.h"
 #include "tested.h"
 #include "util.h"
-#include "mkl.h"
+#include "bw-cblas.h"
+#include "bench.h"
 
 double EPSILON = 1e-4;
 #define DELTA 1e-2
 #define BUFSIZE 1<<26
 
-void initial_step(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
-	
-	double* beta = (double*) malloc(N  * sizeof(double));
-	double* beta_new = (double*) malloc(N * sizeof(double));
-	double* alpha = (double*) malloc(N * T * sizeof(double));
+//cycles and calls of the phases of train (only counted with -DPHASES)
+static phase phases[PHASE_COUNT];
+//time steps per dgemm of the sums of xi
+#define TIME_BLOCK 64
 
-	//FORWARD
+//FORWARD
+//alpha(t) = a^T * alpha(t-1) as one dgemv per step, times b(y(t)) and scaled with ct(t)
+//returns the log-likelihood of y, accumulated from the ct(t) on the way
+double forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T){
 
+	double ctProduct = 1.0;
+	long ctExponent = 0;
 	double ct0 = 0.0;
 
-	//compute alpha(0)   
+	//compute alpha(0)
 	int y0 = y[0];
 	for(int s = 0; s < N; s++){
 		double alphas = p[s] * b[y0*N + s];
 		ct0 += alphas;
 		alpha[s] = alphas;
 	}
-	
+
 	ct0 = 1.0 / ct0;
-    	cblas_dscal(N,ct0,alpha,1);
+	cblas_dscal(N,ct0,alpha,1);
 	ct[0] = ct0;
+	scaleProduct(&ctProduct, &ctExponent, ct0);
 
 	//compute alpha(t)
-	for(int t = 1; t < T-1; t++){
-		double ctt = 0.0;	
+	for(int t = 1; t < T; t++){
+		double ctt = 0.0;
 		const int yt = y[t];
-	
-		for(int s = 0; s<N; s++){
-			double alphatNs = cblas_ddot(N,alpha+(t-1)*N,1,a+s,N);
-			alphatNs *= b[yt*N + s];
+
+		cblas_dgemv(CblasRowMajor,CblasTrans,N,N,1.0,a,N,alpha+(t-1)*N,1,0.0,alpha+t*N,1);
+
+		for(int s = 0; s < N; s++){
+			double alphatNs = alpha[t*N + s] * b[yt*N + s];
 			ctt += alphatNs;
 			alpha[t*N + s] = alphatNs;
 		}
 
 		ctt = 1.0 / ctt;
-        	cblas_dscal(N,ctt,alpha+t*N,1);
+		cblas_dscal(N,ctt,alpha+t*N,1);
 		ct[t] = ctt;
+		scaleProduct(&ctProduct, &ctExponent, ctt);
 	}
-	
-	double ctt = 0.0;	
-	const int yt = y[T-1];
-	
-	for(int s = 0; s<N; s++){
-		double alphatNs = 0;
-       		alphatNs=cblas_ddot(N,alpha+(T-2)*N,1,a+s,N);		
-        	alphatNs *= b[yt*N + s];
-		ctt += alphatNs;
-		alpha[(T-1)*N + s] = alphatNs;
-	}
 
-	ctt = 1.0 / ctt;
-    	cblas_dscal(N,ctt,alpha+(T-1)*N,1);
-    	cblas_dcopy(N,alpha+(T-1)*N,1,gamma_T,1);
-    	ct[T-1] = ctt;
+	return productLogLikelihood(ctProduct, ctExponent);
+}
+
+//FUSED BACKWARD and UPDATE STEP
+//beta(t-1) = a * w(t) with w(t) = b(y(t)) .* beta(t) as one dgemv per step,
+//w of TIME_BLOCK steps is kept so that their sums of xi are one dgemm: a_new += alpha(block)^T * w(block),
+//xi(t)(s,j) = alpha(t)(s) * a(s,j) * w(t+1)(j), so a_new is multiplied by a once at the end
+//p gets gamma(0), gamma_T gets gamma(T-1) (it is added to b_new and gamma_sum in update)
+void backward(const double* const a, const double* const b, double* const p, const int* const y, const double* const alpha, const double* const ct, double* beta, double* beta_new, double* const w, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int K, const int T){
 
-	//FUSED BACKWARD and UPDATE STEP
+	cblas_dcopy(N,alpha+(T-1)*N,1,gamma_T,1);
 
 	for(int s = 0; s < N; s++){
 		beta[s] = ct[T-1];
 		gamma_sum[s] = 0.0;
 
 		for(int j = 0; j < N; j++){
-			a_new[s*N + j] =0.0;
+			a_new[s*N + j] = 0.0;
 		}
 
-		for(int v = 0;  v < K; v++){
+		for(int v = 0; v < K; v++){
 			b_new[v*N + s] = 0.0;
 		}
 	}
-    
-	//compute sum of xi and gamma from t= 0...T-2
-	for(int t = T-1; t > 0; t--){
-		for(int s = 0; s < N ; s++){
-			p[s] = 0.0;
-			beta_new[s]=0.0;
 
-			for(int j = 0; j < N; j++){
-				double temp = a[s*N +j] * beta[j] * b[y[t]*N + j];
-				double xi_sjt = alpha[(t-1)*N + s] * temp;
-				a_new[s*N+j] +=xi_sjt;
-				beta_new[s] += temp;
-				
-			}
+	//blocks of time steps lo...hi, row t-lo of w belongs to row t-1 of alpha
+	for(int hi = T-1; hi > 0; hi -= TIME_BLOCK){
+		const int lo = hi - TIME_BLOCK + 1 > 1 ? hi - TIME_BLOCK + 1 : 1;
 
-			p[s] = alpha[(t-1)*N+s]*beta_new[s];
-			beta_new[s] *= ct[t-1];
-			gamma_sum[s]+= p[s];
+		for(int t = hi; t >= lo; t--){
+			double* const wt = w + (t-lo)*N;
+			const int yt = y[t];
+			const int yt1 = y[t-1];
 
-			for(int v = 0; v < K; v++){
-				int indicator = (int)(y[t-1] == v);
-				b_new[v*N + s] += (double)(indicator)*p[s];
+			for(int j = 0; j < N; j++){
+				wt[j] = b[yt*N + j] * beta[j];
 			}
-		}
-
-		double * temp = beta_new;
-		beta_new = beta;
-		beta = temp;	
-	}
-
-	free(beta);
-	free(beta_new);
-	free(alpha);
-	return;
 
-}
-myInt64 bw(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T, double* beta, double* beta_new ,double* alpha, volatile unsigned char* buf, int maxSteps){
+			cblas_dgemv(CblasRowMajor,CblasNoTrans,N,N,1.0,a,N,wt,1,0.0,beta_new,1);
 
-	double logLikelihood=-DBL_MAX;
-	double disparance;
-	int steps=1;
-	_flush_cache(buf,BUFSIZE);
-	myInt64 start = start_tsc();
+			for(int s = 0; s < N; s++){
+				p[s] = alpha[(t-1)*N + s] * beta_new[s];
+				beta_new[s] *= ct[t-1];
+				gamma_sum[s] += p[s];
+			}
 
-	double ct0 = 0.0;
+			cblas_daxpy(N,1,p,1,b_new+yt1*N,1);
 
-	//compute alpha(0)
-    	int y0 = y[0];
+			double * temp = beta_new;
+			beta_new = beta;
+			beta = temp;
+		}
 
-	for(int s = 0; s < N; s++){
-		double alphas = p[s] * b[y0*N + s];
-		ct0 += alphas;
-		alpha[s] = alphas;
+		//sums of xi of the block without the factor a
+		cblas_dgemm(CblasRowMajor,CblasTrans,CblasNoTrans,N,N,hi-lo+1,1.0,alpha+(lo-1)*N,N,w,N,1.0,a_new,N);
 	}
-	
-	ct0 = 1.0 / ct0;
-    	cblas_dscal(N,ct0,alpha,1);
-	ct[0] = ct0;
 
-	//compute alpha(t)
-	for(int t = 1; t < T-1; t++){
-		double ctt = 0.0;	
-		const int yt = y[t];
-	
-		for(int s = 0; s<N; s++){
-			double alphatNs = cblas_ddot(N,alpha+(t-1)*N,1,a+s,N);
-			alphatNs *= b[yt*N + s];
-			ctt += alphatNs;
-			alpha[t*N + s] = alphatNs;
-		}
- 
-		ctt = 1.0 / ctt;
-        	cblas_dscal(N,ctt,alpha+t*N,1);
-		ct[t] = ctt;
-	}
-		
-	
-	double ctt = 0.0;	
-	const int yt = y[T-1];	
-	for(int s = 0; s<N; s++){
-		double alphatNs = 0;
-       		alphatNs=cblas_ddot(N,alpha+(T-2)*N,1,a+s,N);
-		alphatNs *= b[yt*N + s];
-		ctt += alphatNs;
-		alpha[(T-1)*N + s] = alphatNs;
+	for(int i = 0; i < N*N; i++){
+		a_new[i] *= a[i];
 	}
+}
 
-	ctt = 1.0 / ctt;
-    	cblas_dscal(N,ctt,alpha+(T-1)*N,1);
-    	cblas_dcopy(N,alpha+(T-1)*N,1,gamma_T,1);
-    	ct[T-1] = ctt;
+//new model out of the sums of xi and gamma
+void update(double* const a, double* const b, const int* const y, double* const gamma_sum, double* const gamma_T, const double* const a_new, double* const b_new, const int N, const int K, const int T){
 
-	//FUSED BACKWARD and UPDATE STEP
+	//compute new transition matrix
+	cblas_dcopy(N*N,a_new,1,a,1);
 
 	for(int s = 0; s < N; s++){
-		beta[s] = /* 1* */ct[T-1];
-		gamma_sum[s] = 0.0;
-
-		for(int j = 0; j < N; j++){
-			a_new[s*N + j] =0.0;
-		}
-
-		for(int v = 0;  v < K; v++){
-			b_new[v*N + s] = 0.0;
-		}
-	}
-    
-	//compute sum of xi and gamma
-	for(int t = T-1; t > 0; t--){
-		for(int s = 0; s < N ; s++){
-			p[s] = 0.0;
-			beta_new[s]=0.0;
-
-			for(int j = 0; j < N; j++){
-				double temp = a[s*N +j] * beta[j] * b[y[t]*N + j];
-				double xi_sjt = alpha[(t-1)*N + s] * temp;
-				a_new[s*N+j] +=xi_sjt;
-				beta_new[s] += temp;
-				
-			}
-
-			p[s] = alpha[(t-1)*N+s]*beta_new[s];
-			beta_new[s] *= ct[t-1];
-			gamma_sum[s]+= p[s];
-
-			for(int v = 0; v < K; v++){
-				int indicator = (int)(y[t-1] == v);
-				b_new[v*N + s] += (double)(indicator)*p[s];
-			}
-		}
-
-		double * temp = beta_new;
-		beta_new = beta;
-		beta = temp;	
+		cblas_dscal(N,1/gamma_sum[s],a+s*N,1);
 	}
 
+	cblas_daxpy(N,1,gamma_T,1,b_new+y[T-1]*N,1);
+	cblas_daxpy(N,1,gamma_sum,1,gamma_T,1);
 
-	do{
-    		cblas_daxpy(N,1,gamma_T,1,b_new+y[T-1]*N,1);
-    		cblas_daxpy(N,1,gamma_sum,1,gamma_T,1);
-
-		//compute new emission matrix
-		for(int v = 0; v < K; v++){
-			for(int s = 0; s < N; s++){
-				b[v*N + s] = b_new[v*N + s] / gamma_T[s];
-			}
-		}
-
-		//FORWARD
-
-		double ctt = 0.0;
-
-		//compute alpha(0)
-		int y0 = y[0];
+	//compute new emission matrix
+	for(int v = 0; v < K; v++){
 		for(int s = 0; s < N; s++){
-			double alphas = p[s] * b[y0*N + s];
-			ctt += alphas;
-			alpha[s] = alphas;
-		}
-	
-		ctt = 1.0 / ctt;
-		cblas_dscal(N,ctt,alpha,1);
-    		ct[0] = ctt;
-
-		//Compute alpha(1) and new transitionMatrix
-		ctt = 0.0;	
-		int yt = y[1];	
-		for(int s = 0; s<N; s++){
-			double alphatNs = 0;
-
-			for(int j = 0; j < N; j++){
-				double ajNs =  a_new[j*N + s] / gamma_sum[j];
-				a[j*N + s] = ajNs;
-				alphatNs += alpha[0*N + j] * ajNs;
-			}
-
-			alphatNs *= b[yt*N + s];
-			ctt += alphatNs;
-			alpha[1*N + s] = alphatNs;
-		}
- 
-		ctt = 1.0 / ctt;
-		cblas_dscal(N,ctt,alpha+N,1);
-		ct[1] = ctt;
-	
-		for(int t = 2; t < T-1; t++){
-			ctt = 0.0;	
-			yt = y[t];
-	
-			for(int s = 0; s<N; s++){
-        			double alphatNs=cblas_ddot(N,alpha+(t-1)*N,1,a+s,N);
-				alphatNs *= b[yt*N + s];
-				ctt += alphatNs;
-				alpha[t*N + s] = alphatNs;
-			}
-
-			ctt = 1.0 / ctt;
-			cblas_dscal(N,ctt,alpha+t*N,1);
-			ct[t] = ctt;
-		}
-		
-		//compute alpha(T-1)
-		ctt = 0.0;	
-		yt = y[T-1];	
-		for(int s = 0; s<N; s++){
-	        	double alphatNs=cblas_ddot(N,alpha+(T-2)*N,1,a+s,N);
-			alphatNs *= b[yt*N + s];
-			ctt += alphatNs;
-			alpha[(T-1)*N + s] = alphatNs;
+			b[v*N + s] = b_new[v*N + s] / gamma_T[s];
 		}
+	}
+}
 
-		ctt = 1.0 / ctt;
-		cblas_dscal(N,ctt,alpha+(T-1)*N,1);
-		cblas_dcopy(N,alpha+(T-1)*N,1,gamma_T,1);
-		ct[T-1] = ctt;
-    	
-		//FUSED BACKWARD and UPDATE STEP
-	
-		for(int s = 0; s < N; s++){
-			beta[s] = ct[T-1];
-			gamma_sum[s] = 0.0;
+void initial_step(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
 
-			for(int j = 0; j < N; j++){
-				a_new[s*N + j] =0.0;
-			}
+	double* beta = (double*) malloc(N  * sizeof(double));
+	double* beta_new = (double*) malloc(N * sizeof(double));
+	double* alpha = (double*) malloc(N * T * sizeof(double));
+	double* w = (double*) malloc(N * TIME_BLOCK * sizeof(double));
 
-			for(int v = 0;  v < K; v++){
-				b_new[v*N + s] = 0.0;
-			}
-		}
+	forward(a, b, p, y, alpha, ct, N, T);
+	backward(a, b, p, y, alpha, ct, beta, beta_new, w, gamma_sum, gamma_T, a_new, b_new, N, K, T);
 
-		//compute sum of xi and gamma
-		for(int t = T-1; t > 0; t--){
-			for(int s = 0; s < N ; s++){
-				p[s] = 0.0;
-				beta_new[s]=0.0;
+	free(beta);
+	free(beta_new);
+	free(alpha);
+	free(w);
+}
 
-				for(int j = 0; j < N; j++){
-					double temp = a[s*N +j] * beta[j] * b[y[t]*N + j];
-					double xi_sjt = alpha[(t-1)*N + s] * temp;
-					a_new[s*N+j] +=xi_sjt;
-					beta_new[s] += temp;	
-				}
+//EM steps until the log-likelihood converges, returns the number of steps
+int train(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T, double* beta, double* beta_new ,double* alpha, double* w, int maxSteps){
 
-				p[s] = alpha[(t-1)*N+s]*beta_new[s];
-				beta_new[s] *= ct[t-1];
-				gamma_sum[s]+= p[s]  ;
-	            		b_new[y[t-1]*N+s]+=p[s];
-	        	}
+	double logLikelihood=-DBL_MAX;
+	double disparance;
+	int steps=1;
 
-			double * temp = beta_new;
-			beta_new = beta;
-			beta = temp;	
-		}
+	PHASE_START(PHASE_FORWARD);
+	forward(a, b, p, y, alpha, ct, N, T);
+	PHASE_STOP(PHASE_FORWARD);
+	PHASE_START(PHASE_BACKWARD);
+	backward(a, b, p, y, alpha, ct, beta, beta_new, w, gamma_sum, gamma_T, a_new, b_new, N, K, T);
+	PHASE_STOP(PHASE_BACKWARD);
 
+	do{
+		PHASE_START(PHASE_UPDATE);
+		update(a, b, y, gamma_sum, gamma_T, a_new, b_new, N, K, T);
+		PHASE_STOP(PHASE_UPDATE);
+		PHASE_START(PHASE_FORWARD);
+		double newLogLikelihood = forward(a, b, p, y, alpha, ct, N, T);
+		PHASE_STOP(PHASE_FORWARD);
+		PHASE_START(PHASE_BACKWARD);
+		backward(a, b, p, y, alpha, ct, beta, beta_new, w, gamma_sum, gamma_T, a_new, b_new, N, K, T);
+		PHASE_STOP(PHASE_BACKWARD);
+
+		PHASE_START(PHASE_FINISHED);
 	        steps+=1;
-	
+
 	        double oldLogLikelihood=logLikelihood;
-	        double newLogLikelihood = 0.0;
-	
-        	for(int time = 0; time < T; time++){
-		        newLogLikelihood -= log2(ct[time]);
-        	}
-	        
+
 	       	logLikelihood=newLogLikelihood;
 		disparance=newLogLikelihood-oldLogLikelihood;
+		PHASE_STOP(PHASE_FINISHED);
 
 	}while (disparance>EPSILON && steps<maxSteps);
 
+	PHASE_START(PHASE_UPDATE);
+	update(a, b, y, gamma_sum, gamma_T, a_new, b_new, N, K, T);
+	PHASE_STOP(PHASE_UPDATE);
 
-	//compute new transition matrix
-	for(int s = 0; s < N; s++){
-        	double denom=1/gamma_sum[s];
-        	cblas_dscal(N,denom,a_new+s*N,1);
-	}
+	return steps;
+}
 
-	cblas_dcopy(N*N,a_new,1,a,1);
-	cblas_daxpy(N,1,gamma_T,1,gamma_sum,1);
-	cblas_daxpy(N,1,gamma_T,1,b_new+y[T-1]*N,1);
-	
-	//compute new emission matrix
-	for(int v = 0; v < K; v++){
-		for(int s = 0; s < N; s++){
-			b[v*N + s] = b_new[v*N + s] / gamma_sum[s];
-		}
-	}
+myInt64 bw(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T, double* beta, double* beta_new ,double* alpha, double* w, volatile unsigned char* buf, int maxSteps, long* const totalSteps){
+
+	_flush_cache(buf,BUFSIZE);
+	myInt64 start = start_tsc();
+
+	int steps = train(a, b, p, y, gamma_sum, gamma_T, a_new, b_new, ct, N, K, T, beta, beta_new, alpha, w, maxSteps);
 
 	myInt64 cycles = stop_tsc(start);
+	*totalSteps += steps;
         return cycles/steps;
 
 }
@@ -380,154 +221,71 @@ void baum_welch(double* const a, double* const b, double* const p, const int* co
 	double* beta = (double*) malloc(N  * sizeof(double));
 	double* beta_new = (double*) malloc(N * sizeof(double));
 	double* alpha = (double*) malloc(N * T * sizeof(double));
+	double* w = (double*) malloc(N * TIME_BLOCK * sizeof(double));
 
-    	cblas_daxpy(N,1,gamma_T,1,b_new+y[T-1]*N,1);
-    	cblas_daxpy(N,1,gamma_sum,1,gamma_T,1);
+	update(a, b, y, gamma_sum, gamma_T, a_new, b_new, N, K, T);
+	forward(a, b, p, y, alpha, ct, N, T);
+	backward(a, b, p, y, alpha, ct, beta, beta_new, w, gamma_sum, gamma_T, a_new, b_new, N, K, T);
 
-	//compute new emission matrix
-	for(int v = 0; v < K; v++){
-		for(int s = 0; s < N; s++){
-			b[v*N + s] = b_new[v*N + s] / gamma_T[s];
-		}
-	}
-
-	//FORWARD
-
-	double ctt = 0.0;
-
-	//compute alpha(0)
-	int y0 = y[0];
-	for(int s = 0; s < N; s++){
-		double alphas = p[s] * b[y0*N + s];
-		ctt += alphas;
-		alpha[s] = alphas;
-	}
-	
-	ctt = 1.0 / ctt;
-    	cblas_dscal(N,ctt,alpha,1);
-    	ct[0] = ctt;
-
-	//Compute alpha(1) and new transitionMatrix
-	ctt = 0.0;	
-	int yt = y[1];	
-	for(int s = 0; s<N; s++){
-		double alphatNs = 0;
-
-		for(int j = 0; j < N; j++){
-			double ajNs =  a_new[j*N + s] / gamma_sum[j];
-			a[j*N + s] = ajNs;
-			alphatNs += alpha[0*N + j] * ajNs;
-		}
+	free(alpha);
+	free(beta);
+	free(beta_new);
+	free(w);
+}
 
-		alphatNs *= b[yt*N + s];
-		ctt += alphatNs;
-		alpha[1*N + s] = alphatNs;
-	}
+void final_scaling(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
+	update(a, b, y, gamma_sum, gamma_T, a_new, b_new, N, K, T);
+}
 
-	ctt = 1.0 / ctt;
-    	cblas_dscal(N,ctt,alpha+N,1);
-	ct[1] = ctt;
 
-	for(int t = 2; t < T-1; t++){
-		ctt = 0.0;	
-		yt = y[t];	
 
-		for(int s = 0; s<N; s++){
-            		double alphatNs=cblas_ddot(N,alpha+(t-1)*N,1,a+s,N);
-			alphatNs *= b[yt*N + s];
-			ctt += alphatNs;
-			alpha[t*N + s] = alphatNs;
-		}
+static void bench_run(const problem* const pb, measurement* const m){
 
-		ctt = 1.0 / ctt;
-		cblas_dscal(N,ctt,alpha+t*N,1);
-		ct[t] = ctt;
-	}
-		
-	//compute alpha(T-1)
-	ctt = 0.0;	
-	yt = y[T-1];	
-	for(int s = 0; s<N; s++){
-        	double alphatNs=cblas_ddot(N,alpha+(T-2)*N,1,a+s,N);
-		alphatNs *= b[yt*N + s];
-		ctt += alphatNs;
-		alpha[(T-1)*N + s] = alphatNs;
-	}
+	const int N = pb->N;
+	const int K = pb->K;
+	const int T = pb->T;
 
-	ctt = 1.0 / ctt;
-    	cblas_dscal(N,ctt,alpha+(T-1)*N,1);
-    	cblas_dcopy(N,alpha+(T-1)*N,1,gamma_T,1);
-    	ct[T-1] = ctt;
-    	
-	//FUSED BACKWARD and UPDATE STEP
+	double* gamma_T = (double*) malloc( N * sizeof(double));
+	double* gamma_sum = (double*) malloc( N * sizeof(double));
+	double* a_new = (double*) malloc(N * N * sizeof(double));
+	double* b_new = (double*) malloc(K * N * sizeof(double));
+	double* ct = (double*) malloc(T*sizeof(double));
+	double* beta = (double*) malloc(N  * sizeof(double));
+	double* beta_new = (double*) malloc(N * sizeof(double));
+	double* alpha = (double*) malloc(N * T * sizeof(double));
+	double* w = (double*) malloc(N * TIME_BLOCK * sizeof(double));
 
-	for(int s = 0; s < N; s++){
-		beta[s] = /* 1* */ct[T-1];
-		gamma_sum[s] = 0.0;
+	memcpy(m->transitionMatrix, pb->transitionMatrix, N*N*sizeof(double));
+	memcpy(m->emissionMatrix, pb->emissionMatrix, N*K*sizeof(double));
+	memcpy(m->stateProb, pb->stateProb, N * sizeof(double));
+	EPSILON = pb->epsilon;
 
-		for(int j = 0; j < N; j++){
-			a_new[s*N + j] =0.0;
-		}
+	//observable major like in main
+	transpose(m->emissionMatrix, N, K);
 
-		for(int v = 0;  v < K; v++){
-			b_new[v*N + s] = 0.0;
-		}
-	}
+	resetPhases(phases);
+	_flush_cache(pb->buf,pb->bufsize);
+	myInt64 start = start_tsc();
 
-	//compute sum of xi and gamma 
-	for(int t = T-1; t > 0; t--){
-		for(int s = 0; s < N ; s++){
-			p[s] = 0.0;
-			beta_new[s]=0.0;
+	m->steps = train(m->transitionMatrix, m->emissionMatrix, m->stateProb, pb->observations, gamma_sum, gamma_T, a_new, b_new, ct, N, K, T, beta, beta_new, alpha, w, pb->maxSteps);
 
-			for(int j = 0; j < N; j++){
-				double temp = a[s*N +j] * beta[j] * b[y[t]*N + j];
-				double xi_sjt = alpha[(t-1)*N + s] * temp;
-				a_new[s*N+j] +=xi_sjt;
-				beta_new[s] += temp;
-				
-			}
+	m->cycles = stop_tsc(start);
+	memcpy(m->phases, phases, sizeof(phases));
 
-			p[s] = alpha[(t-1)*N+s]*beta_new[s];
-			beta_new[s] *= ct[t-1];
-			gamma_sum[s]+= p[s];
-            		b_new[y[t-1]*N+s]+=p[s];
-		}
-		
-		double * temp = beta_new;
-		beta_new = beta;
-		beta = temp;	
-	}
+	transpose(m->emissionMatrix, K, N);
 
-	free(alpha);
+	free(gamma_T);
+	free(gamma_sum);
+	free(a_new);
+	free(b_new);
+	free(ct);
 	free(beta);
 	free(beta_new);
-	
-	return;
-}
-
-void final_scaling(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
-
-	//compute new transition matrix
-	for(int s = 0; s < N; s++){
-        	double denom=1/gamma_sum[s];
-        	cblas_dscal(N,denom,a_new+s*N,1);
-
-	}
-
-	cblas_dcopy(N*N,a_new,1,a,1);
-    	cblas_daxpy(N,1,gamma_T,1,gamma_sum,1);
-    	cblas_daxpy(N,1,gamma_T,1,b_new+y[T-1]*N,1);
-
-	//compute new emission matrix
-	for(int v = 0; v < K; v++){
-		for(int s = 0; s < N; s++){
-			b[v*N + s] = b_new[v*N + s] / gamma_sum[s];
-		}
-	}
+	free(alpha);
+	free(w);
 }
 
-
+const variant bench_bla = {"bla", 1, 1, bench_run};
 
 void heatup(double* const transitionMatrix,double* const stateProb,double* const emissionMatrix,const int* const observations,const int hiddenStates,const int differentObservables,const int T){
 
@@ -606,6 +364,7 @@ int main(int argc, char *argv[]){
 	double* beta = (double*) malloc(hiddenStates  * sizeof(double));
 	double* beta_new = (double*) malloc(hiddenStates * sizeof(double));
 	double* alpha = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* w = (double*) malloc(hiddenStates * TIME_BLOCK * sizeof(double));
 	
 	//random init transition matrix, emission matrix and state probabilities.
 	makeMatrix(hiddenStates, hiddenStates, transitionMatrix);
@@ -625,6 +384,8 @@ int main(int argc, char *argv[]){
 	//matrix for flushing cache
 	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
 	
+	long totalSteps = 0;
+
 	for (int run=0; run<maxRuns; run++){
 
 		//reset to init
@@ -632,13 +393,14 @@ int main(int argc, char *argv[]){
    		memcpy(emissionMatrix, emissionMatrixSafe, hiddenStates*differentObservables*sizeof(double));
       		memcpy(stateProb, stateProbSafe, hiddenStates * sizeof(double));
 
-		runs[run]=bw(transitionMatrix,emissionMatrix,stateProb,observations, gamma_sum, gamma_T, a_new, b_new, ct,hiddenStates,differentObservables, T, beta, beta_new ,alpha, buf, maxSteps);
+		runs[run]=bw(transitionMatrix,emissionMatrix,stateProb,observations, gamma_sum, gamma_T, a_new, b_new, ct,hiddenStates,differentObservables, T, beta, beta_new ,alpha, w, buf, maxSteps, &totalSteps);
 
 	}
 
 	qsort (runs, maxRuns, sizeof (double), compare_doubles);
   	double medianTime = runs[maxRuns/2];
 	printf("Median Time: \t %lf cycles \n", medianTime); 
+	printPhases(phases, totalSteps);
 	
 	//used for testing
 	memcpy(transitionMatrixTesting, transitionMatrixSafe, hiddenStates*hiddenStates*sizeof(double));
@@ -690,5 +452,6 @@ int main(int argc, char *argv[]){
     	free(beta);
 	free(beta_new);
 	free(alpha);
+	free(w);
 	return 0; 
 } 
@@ -0,0 +1,106 @@
+#include "bw-cblas.h"
+
+//Built-in fallback for the BLAS routines of bw-bla.c, plain loops like the reference BLAS.
+//Only compiled without a BLAS provider (BW_BLAS_BUILTIN).
+
+double cblas_ddot(const int N, const double* const x, const int incx, const double* const y, const int incy){
+
+	double sum = 0.0;
+
+	for(int i = 0; i < N; i++){
+		sum += x[i*incx] * y[i*incy];
+	}
+
+	return sum;
+}
+
+void cblas_daxpy(const int N, const double alpha, const double* const x, const int incx, double* const y, const int incy){
+
+	for(int i = 0; i < N; i++){
+		y[i*incy] += alpha * x[i*incx];
+	}
+}
+
+void cblas_dscal(const int N, const double alpha, double* const x, const int incx){
+
+	for(int i = 0; i < N; i++){
+		x[i*incx] *= alpha;
+	}
+}
+
+void cblas_dcopy(const int N, const double* const x, const int incx, double* const y, const int incy){
+
+	for(int i = 0; i < N; i++){
+		y[i*incy] = x[i*incx];
+	}
+}
+
+void cblas_dgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE trans, const int M, const int N, const double alpha, const double* const A, const int lda, const double* const x, const int incx, const double beta, double* const y, const int incy){
+
+	//column major A is the row major transpose
+	const int transposed = (trans != CblasNoTrans) != (order == CblasColMajor);
+	const int rows = order == CblasColMajor ? N : M;
+	const int cols = order == CblasColMajor ? M : N;
+	const int leny = transposed ? cols : rows;
+	const int lenx = transposed ? rows : cols;
+
+	for(int i = 0; i < leny; i++){
+		y[i*incy] = beta == 0.0 ? 0.0 : beta * y[i*incy];
+	}
+
+	if(!transposed){
+		for(int i = 0; i < rows; i++){
+			double sum = 0.0;
+
+			for(int j = 0; j < lenx; j++){
+				sum += A[i*lda + j] * x[j*incx];
+			}
+
+			y[i*incy] += alpha * sum;
+		}
+	}else{
+		//row by row, so A is read in its storage order
+		for(int i = 0; i < rows; i++){
+			const double xi = alpha * x[i*incx];
+
+			for(int j = 0; j < leny; j++){
+				y[j*incy] += A[i*lda + j] * xi;
+			}
+		}
+	}
+}
+
+void cblas_dgemm(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE transA, const enum CBLAS_TRANSPOSE transB, const int M, const int N, const int K, const double alpha, const double* const A, const int lda, const double* const B, const int ldb, const double beta, double* const C, const int ldc){
+
+	//column major C = op(A)*op(B) is the row major C^T = op(B)^T*op(A)^T
+	if(order == CblasColMajor){
+		cblas_dgemm(CblasRowMajor, transB, transA, N, M, K, alpha, B, ldb, A, lda, beta, C, ldc);
+		return;
+	}
+
+	const int ta = transA != CblasNoTrans;
+	const int tb = transB != CblasNoTrans;
+
+	for(int i = 0; i < M; i++){
+		for(int j = 0; j < N; j++){
+			C[i*ldc + j] = beta == 0.0 ? 0.0 : beta * C[i*ldc + j];
+		}
+	}
+
+	//i-k-j order, the rows of B and C are walked contiguously
+	for(int i = 0; i < M; i++){
+		for(int k = 0; k < K; k++){
+			const double aik = alpha * (ta ? A[k*lda + i] : A[i*lda + k]);
+
+			if(tb){
+				for(int j = 0; j < N; j++){
+					C[i*ldc + j] += aik * B[j*ldb + k];
+				}
+			}else{
+				for(int j = 0; j < N; j++){
+					C[i*ldc + j] += aik * B[k*ldb + j];
+				}
+			}
+		}
+	}
+}
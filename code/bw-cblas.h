@@ -0,0 +1,34 @@
+#ifndef CBLAS_FILE_
+#define CBLAS_FILE_
+
+//CBLAS used by bw-bla.c, the provider is picked when building (make bla BLAS=...):
+//BW_BLAS_MKL includes mkl.h, BW_BLAS_CBLAS the cblas.h of OpenBLAS, BLIS or the reference implementation,
+//otherwise the plain C routines of bw-cblas.c are declared here (for machines without any BLAS).
+
+#if defined(BW_BLAS_MKL)
+#include "mkl.h"
+#elif defined(BW_BLAS_CBLAS)
+#include <cblas.h>
+#else
+
+enum CBLAS_ORDER {CblasRowMajor = 101, CblasColMajor = 102};
+enum CBLAS_TRANSPOSE {CblasNoTrans = 111, CblasTrans = 112, CblasConjTrans = 113};
+
+//only positive increments are supported
+double cblas_ddot(const int N, const double* const x, const int incx, const double* const y, const int incy);
+
+void cblas_daxpy(const int N, const double alpha, const double* const x, const int incx, double* const y, const int incy);
+
+void cblas_dscal(const int N, const double alpha, double* const x, const int incx);
+
+void cblas_dcopy(const int N, const double* const x, const int incx, double* const y, const int incy);
+
+//y = alpha*op(A)*x + beta*y for the M x N matrix A
+void cblas_dgemv(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE trans, const int M, const int N, const double alpha, const double* const A, const int lda, const double* const x, const int incx, const double beta, double* const y, const int incy);
+
+//C = alpha*op(A)*op(B) + beta*C for the M x N matrix C and the inner dimension K
+void cblas_dgemm(const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE transA, const enum CBLAS_TRANSPOSE transB, const int M, const int N, const int K, const double alpha, const double* const A, const int lda, const double* const B, const int ldb, const double beta, double* const C, const int ldc);
+
+#endif
+
+#endif
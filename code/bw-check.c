@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "tested.h"
+#include "util.h"
+#include "bw.h"
+
+double EPSILON = 1e-4;
+#define DELTA 1e-2
+//looser for the single precision engine, float only has about 7 digits
+#define FLOAT_DELTA 1e-1
+#define SEQUENCES 4
+
+//the options of libbaumwelch, each trained on its own against tested_implementation
+//the kernel family comes from BW_KERNELS=scalar|avx2|avx512 (make check runs all three)
+enum {
+	CASE_DEFAULT,
+	CASE_TIME_PARALLEL,
+	CASE_CHECKPOINT,
+	CASE_MIXED,
+	CASE_FLOAT,
+	CASE_LOG_SPACE,
+	CASE_SPARSE,
+	CASE_BANDED,
+	CASE_AB_FULL,
+	CASE_AB_PRESENT,
+	CASE_AB_ON_THE_FLY,
+	CASE_XI_BLOCK,
+	CASE_COUNT
+};
+
+static const char* const caseNames[CASE_COUNT] = {"default", "time_parallel", "checkpoint", "mixed", "float", "log_space", "sparse", "banded", "ab_full", "ab_present", "ab_on_the_fly", "xi_block"};
+
+static void setCase(const int c, bw_options* const options){
+
+	bw_options_init(options);
+	options->epsilon = EPSILON;
+
+	switch(c){
+	case CASE_TIME_PARALLEL:
+		options->threads = 4;
+		options->time_parallel = 1;
+		break;
+	case CASE_CHECKPOINT:
+		options->checkpoint = 1;
+		break;
+	case CASE_MIXED:
+		options->precision = BW_MIXED;
+		break;
+	case CASE_FLOAT:
+		options->precision = BW_FLOAT;
+		break;
+	case CASE_LOG_SPACE:
+		options->log_space = 1;
+		break;
+	case CASE_SPARSE:
+		options->sparse = 1;
+		break;
+	case CASE_BANDED:
+		options->banded = 1;
+		break;
+	case CASE_AB_FULL:
+		options->ab = BW_AB_FULL;
+		break;
+	case CASE_AB_PRESENT:
+		options->ab = BW_AB_PRESENT;
+		break;
+	case CASE_AB_ON_THE_FLY:
+		options->ab = BW_AB_ON_THE_FLY;
+		break;
+	case CASE_XI_BLOCK:
+		options->xi_block = 32;
+		break;
+	}
+}
+
+static int finiteModel(const double* const a, const double* const b, const double* const p, const int N, const int K){
+
+	for(int i = 0; i < N*N; i++){
+		if(!isfinite(a[i])){
+			return 0;
+		}
+	}
+
+	for(int i = 0; i < N*K; i++){
+		if(!isfinite(b[i])){
+			return 0;
+		}
+	}
+
+	for(int i = 0; i < N; i++){
+		if(!isfinite(p[i])){
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+//trains every case from the initial model and compares it with the reference, returns the number of failures
+static int checkModel(const char* name, const int N, const int K, const int T, const int* const observations, const double* const a0, const double* const b0, const double* const p0){
+
+	double* a = (double*) malloc(N*N*sizeof(double));
+	double* b = (double*) malloc(N*K*sizeof(double));
+	double* p = (double*) malloc(N*sizeof(double));
+	double* aTesting = (double*) malloc(N*N*sizeof(double));
+	double* bTesting = (double*) malloc(N*K*sizeof(double));
+	double* pTesting = (double*) malloc(N*sizeof(double));
+
+	memcpy(aTesting, a0, N*N*sizeof(double));
+	memcpy(bTesting, b0, N*K*sizeof(double));
+	memcpy(pTesting, p0, N*sizeof(double));
+	tested_implementation(N, K, T, aTesting, bTesting, pTesting, (int*) observations, EPSILON, DELTA);
+
+	int failures = 0;
+
+	//a model of its own for every case, so that one case can not leave anything behind for the next
+	for(int c = 0; c < CASE_COUNT; c++){
+		bw_options options;
+		setCase(c, &options);
+
+		bw_model* model = bw_model_create(N, K);
+		bw_model_set(model, a0, b0, p0);
+		const int steps = bw_train(model, observations, T, &options);
+
+		//BW_FLOAT and BW_MIXED need AVX2, the scalar family has no kernels for them
+		if(steps < 0 && (c == CASE_FLOAT || c == CASE_MIXED)){
+			printf("%s %s: skipped \n", name, caseNames[c]);
+			bw_model_free(model);
+			continue;
+		}
+
+		bw_model_get(model, a, b, p);
+		bw_model_free(model);
+		const double delta = c == CASE_FLOAT ? FLOAT_DELTA : DELTA;
+		const int ok = steps > 0 && finiteModel(a, b, p, N, K)
+			&& similar(aTesting, a, N, N, delta) && similar(bTesting, b, N, K, delta);
+
+		printf("%s %s: %s \n", name, caseNames[c], ok ? "ok" : "FAIL");
+		failures += !ok;
+	}
+
+	//SEQUENCES pieces of the observations on one and on SEQUENCES threads, the pooled sums do not depend on the split
+	const int* sequences[SEQUENCES];
+	int lengths[SEQUENCES];
+
+	for(int i = 0; i < SEQUENCES; i++){
+		sequences[i] = observations + i*(T/SEQUENCES);
+		lengths[i] = T/SEQUENCES;
+	}
+
+	bw_options options;
+	bw_options_init(&options);
+	options.epsilon = EPSILON;
+
+	bw_model* model = bw_model_create(N, K);
+	bw_model_set(model, a0, b0, p0);
+	bw_train_multi(model, sequences, lengths, SEQUENCES, &options);
+	bw_model_get(model, aTesting, bTesting, pTesting);
+
+	options.threads = SEQUENCES;
+	bw_model_set(model, a0, b0, p0);
+	const int steps = bw_train_multi(model, sequences, lengths, SEQUENCES, &options);
+	bw_model_get(model, a, b, p);
+
+	const int ok = steps > 0 && finiteModel(a, b, p, N, K)
+		&& similar(aTesting, a, N, N, DELTA) && similar(bTesting, b, N, K, DELTA);
+	printf("%s threads: %s \n", name, ok ? "ok" : "FAIL");
+	failures += !ok;
+
+	bw_model_free(model);
+	free(a);
+	free(b);
+	free(p);
+	free(aTesting);
+	free(bTesting);
+	free(pTesting);
+
+	return failures;
+}
+
+//left-to-right model: state s only goes to s...s+width-1, the last one stays
+static void makeBanded(const int N, const int width, double* const a){
+
+	memset(a, 0, N*N*sizeof(double));
+
+	for(int s = 0; s < N; s++){
+		const int reach = s + width < N ? width : N - s;
+		makeProbabilities(a + s*N + s, reach);
+	}
+}
+
+//options of libbaumwelch against tested_implementation on a random model and on a left-to-right model
+int main(int argc, char *argv[]){
+
+	if(argc < 5){
+		printf("USAGE: ./run <seed> <hiddenStates> <observables> <T> \n");
+		return -1;
+	}
+
+	const int seed = atoi(argv[1]);
+	const int hiddenStates = atoi(argv[2]);
+	const int differentObservables = atoi(argv[3]);
+	const int T = atoi(argv[4]);
+
+	if(argc ==6){
+		int exp = atoi(argv[5]);
+		EPSILON  = pow(10,-exp);
+	}
+
+	if(hiddenStates <= 0 || differentObservables <= 0 || T < SEQUENCES){
+		printf("hiddenStates and observables have to be positive, T at least %d \n", SEQUENCES);
+		return -1;
+	}
+
+	srand(seed);
+
+	const int N = hiddenStates;
+	const int K = differentObservables;
+	double* groundTransitionMatrix = (double*) malloc(N*N*sizeof(double));
+	double* groundEmissionMatrix = (double*) malloc(N*K*sizeof(double));
+	double* transitionMatrix = (double*) malloc(N*N*sizeof(double));
+	double* emissionMatrix = (double*) malloc(N*K*sizeof(double));
+	double* stateProb = (double*) malloc(N*sizeof(double));
+	int* observations = (int*) malloc(T*sizeof(int));
+
+	printf("kernels %s, %d %d %d %d \n", bw_kernels(), seed, N, K, T);
+
+	//random dense model like the harnesses
+	makeMatrix(N, N, groundTransitionMatrix);
+	makeMatrix(N, K, groundEmissionMatrix);
+	int groundInitialState = rand()%N;
+	makeObservations(N, K, groundInitialState, groundTransitionMatrix, groundEmissionMatrix, T, observations);
+
+	makeMatrix(N, N, transitionMatrix);
+	makeMatrix(N, K, emissionMatrix);
+	makeProbabilities(stateProb, N);
+
+	int failures = checkModel("dense", N, K, T, observations, transitionMatrix, emissionMatrix, stateProb);
+
+	//left-to-right model with a band of 3 diagonals starting in state 0, most states can not reach
+	//the states of most rows any more, so whole rows of log terms are -inf
+	makeBanded(N, 3, groundTransitionMatrix);
+	makeObservations(N, K, 0, groundTransitionMatrix, groundEmissionMatrix, T, observations);
+
+	makeBanded(N, 3, transitionMatrix);
+	makeMatrix(N, K, emissionMatrix);
+	makeProbabilities(stateProb, N);
+
+	failures += checkModel("left-to-right", N, K, T, observations, transitionMatrix, emissionMatrix, stateProb);
+
+	free(groundTransitionMatrix);
+	free(groundEmissionMatrix);
+	free(transitionMatrix);
+	free(emissionMatrix);
+	free(stateProb);
+	free(observations);
+
+	if(failures > 0){
+		printf("%d failed \n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -8,11 +8,15 @@
 #include "io.h"
 #include "tested.h"
 #include "util.h"
+#include "bench.h"
 
 double EPSILON = 1e-4;
 #define DELTA 1e-2
 #define BUFSIZE 1<<26 
 
+//cycles and calls of the phases of train (only counted with -DPHASES)
+static phase phases[PHASE_COUNT];
+
 void forward(const double* const a, const double* const p, const double* const b, double* const alpha,  const int * const y, double* const ct, const int N, const int K, const int T){
 
 	double ct0 = 0.0;
@@ -86,7 +90,7 @@ void backward(const double* const a, const double* const b, double* const beta,
 	return;
 }
 
-void update(double* const a, double* const p, double* const b, const double* const alpha, const double* const beta, double* const gamma, double* const xi, const int* const y, const double* const ct,double* const inv_ct,const int N, const int K, const int T){
+void update(double* const a, double* const p, double* const b, const double* const alpha, const double* const beta, double* const gamma, double* const xi, const int* const y, const int* const start, const int* const positions, const double* const ct,double* const inv_ct,const int N, const int K, const int T){
 
 
 	double xi_sum, gamma_sum_numerator, gamma_sum_denominator;
@@ -138,10 +142,10 @@ void update(double* const a, double* const p, double* const b, const double* con
 		for(int v = 0; v < K; v++){
 			gamma_sum_numerator = 0.;
 
-			for(int t = 0; t < T; t++){
-				if(y[t] == v){
-					gamma_sum_numerator += gamma[t*N + s]*inv_ct[t];
-				}
+			//only the time steps with y[t] == v
+			for(int i = start[v]; i < start[v+1]; i++){
+				const int t = positions[i];
+				gamma_sum_numerator += gamma[t*N + s]*inv_ct[t];
 			}
 
 			// new emmision matrix
@@ -152,6 +156,211 @@ void update(double* const a, double* const p, double* const b, const double* con
 	return;
 }
 
+//the timed part of a run: EM steps until the log-likelihood converges, returns the number of steps
+int train(double* const transitionMatrix, double* const stateProb, double* const emissionMatrix, const int* const observations, double* const alpha, double* const beta, double* const gamma, double* const xi, double* const ct, double* const inv_ct, int* const start_symbol, int* const positions, const int hiddenStates, const int differentObservables, const int T, const int maxSteps){
+
+	double logLikelihood=-DBL_MAX;
+	double disparance;
+	int steps=0;
+
+	//the observations do not change, sort them once per run
+	symbolPositions(observations, differentObservables, T, start_symbol, positions);
+	
+	do{
+            		//FORWARD
+	        PHASE_START(PHASE_FORWARD);
+
+	        double ctProduct = 1.0;
+	        long ctExponent = 0;
+	        double ct0 = 0.0;
+	        int y0 = observations[0];
+
+	        //compute alpha(0) and scaling factor for t = 0
+	        for(int s = 0; s < hiddenStates; s++){
+		        double alphas = stateProb[s] * emissionMatrix[s*differentObservables + y0];
+		        ct0 += alphas;
+		        alpha[s] = alphas;
+	        }
+	        
+	        ct0 = 1.0 / ct0;
+
+	        for(int s = 0; s < hiddenStates; s++){
+		        alpha[s] *= ct0;
+	        }
+
+	        ct[0] = ct0;
+	        scaleProduct(&ctProduct, &ctExponent, ct0);
+
+	        for(int t = 1; t < T; t++){
+		        double ctt = 0.0;	
+		        const int yt = observations[t];
+		        for(int s = 0; s<hiddenStates; s++){
+			        double alphatNs = 0;
+
+			        for(int j = 0; j < hiddenStates; j++){
+				        alphatNs += alpha[(t-1)*hiddenStates + j] * transitionMatrix[j*hiddenStates + s];
+			        }
+
+			        alphatNs *= emissionMatrix[s*differentObservables + yt];
+			        ctt += alphatNs;
+			        alpha[t*hiddenStates + s] = alphatNs;
+		        }
+ 
+		        ctt = 1.0 / ctt;
+		        
+		        for(int s = 0; s<hiddenStates; s++){
+			        alpha[t*hiddenStates+s] *= ctt;
+		        }
+
+		        ct[t] = ctt;
+		        scaleProduct(&ctProduct, &ctExponent, ctt);
+	        }	
+	        PHASE_STOP(PHASE_FORWARD);
+
+	        //BACKWARD
+	        PHASE_START(PHASE_BACKWARD);
+
+	        double ctT1 = ct[T-1];	
+
+	        for(int s = 0; s < hiddenStates; s++){
+		        beta[(T-1)*hiddenStates + s] = ctT1;
+	        }
+
+	        for(int t = T-1; t > 0; t--){
+		        const int yt =observations[t];
+		        const double ctt1 = ct[t-1];
+
+		        for(int s = 0; s < hiddenStates; s++){
+			        double betat1Ns = 0;
+
+			        for(int j = 0; j < hiddenStates; j++){
+				        betat1Ns += beta[t*hiddenStates + j ] * transitionMatrix[s*hiddenStates + j] * emissionMatrix[j*differentObservables + yt];
+			        }
+
+			        beta[(t-1)*hiddenStates + s] = ctt1*betat1Ns;
+		        }
+	        }
+	        PHASE_STOP(PHASE_BACKWARD);
+
+        		 //UPDATE
+	        PHASE_START(PHASE_UPDATE);
+	        double xi_sum, gamma_sum_numerator, gamma_sum_denominator;
+
+	        for(int t = 0; t < T; t++){
+		        for(int s = 0; s < hiddenStates; s++){ 
+			        gamma[t*hiddenStates + s] = alpha[t*hiddenStates + s] * beta[t*hiddenStates + s];
+		        }
+	        }
+
+	        for(int t = 1; t < T; t++){
+		        const int yt = observations[t];
+
+		        for(int s = 0; s < hiddenStates; s++){
+			        const double alphat1Ns = alpha[(t-1)*hiddenStates + s];
+
+			        for(int j = 0; j < hiddenStates; j++){
+				        xi[((t-1) * hiddenStates + s) * hiddenStates + j] = alphat1Ns * transitionMatrix[s*hiddenStates + j] * beta[t*hiddenStates + j] * emissionMatrix[j*differentObservables + yt]; 
+			        }
+		        }
+       	 }
+
+	        const double ct0div = 1/ct[0];
+	        inv_ct[0] = ct0div;
+
+	        for(int s = 0; s < hiddenStates; s++){
+        	    		stateProb[s] = gamma[s]*ct0div;
+        	    
+		        for(int j = 0; j < hiddenStates; j++){
+			        xi_sum = 0.;
+			        gamma_sum_denominator = 0.;
+
+			        for(int t = 1; t < T; t++){
+				        xi_sum += xi[((t-1) * hiddenStates + s) * hiddenStates + j];	
+				        double inv_ctt1 = 1 / ct[t-1];
+				        inv_ct[t-1] = inv_ctt1;
+				        gamma_sum_denominator += gamma[(t-1)*hiddenStates + s]*inv_ctt1;
+			        }
+
+			        // new transition matrix
+			        transitionMatrix[s*hiddenStates + j] = xi_sum / gamma_sum_denominator;
+		        }
+
+		        double inv_ctt1 = 1/ct[T-1];
+		        inv_ct[T-1]=inv_ctt1;
+		        gamma_sum_denominator += gamma[(T-1)*hiddenStates + s]*inv_ctt1;
+		        const double gamma_sum_denominator_div = 1/gamma_sum_denominator;
+
+		        for(int v = 0; v < differentObservables; v++){
+			        gamma_sum_numerator = 0.;
+
+			        for(int i = start_symbol[v]; i < start_symbol[v+1]; i++){
+				        const int t = positions[i];
+				        gamma_sum_numerator += gamma[t*hiddenStates + s]*inv_ct[t];
+			        }
+
+			        // new emmision matrix
+			        emissionMatrix[s*differentObservables + v] = gamma_sum_numerator * gamma_sum_denominator_div;
+		        }
+	        }
+	        PHASE_STOP(PHASE_UPDATE);
+
+	        PHASE_START(PHASE_FINISHED);
+        		steps+=1;
+
+	        double oldLogLikelihood=logLikelihood;
+	        double newLogLikelihood = productLogLikelihood(ctProduct, ctExponent);
+        
+        	logLikelihood=newLogLikelihood;
+        	disparance=newLogLikelihood-oldLogLikelihood;
+	        PHASE_STOP(PHASE_FINISHED);
+
+	}while (disparance>EPSILON && steps<maxSteps);
+
+	return steps;
+}
+
+//one run for the benchmark driver, the model is trained in place in m
+static void bench_run(const problem* const pb, measurement* const m){
+
+	const int hiddenStates = pb->N;
+	const int differentObservables = pb->K;
+	const int T = pb->T;
+
+	double* alpha = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* beta = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* gamma = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* xi = (double*) malloc(hiddenStates * hiddenStates * (T-1) * sizeof(double)); 
+	double* ct = (double*) malloc(T*sizeof(double));
+	double* inv_ct = (double*) malloc(T*sizeof(double));
+	int* start_symbol = (int*) malloc((differentObservables+1) * sizeof(int));
+	int* positions = (int*) malloc(T * sizeof(int));
+
+	memcpy(m->transitionMatrix, pb->transitionMatrix, hiddenStates*hiddenStates*sizeof(double));
+	memcpy(m->emissionMatrix, pb->emissionMatrix, hiddenStates*differentObservables*sizeof(double));
+	memcpy(m->stateProb, pb->stateProb, hiddenStates * sizeof(double));
+	EPSILON = pb->epsilon;
+
+	resetPhases(phases);
+	_flush_cache(pb->buf,pb->bufsize);
+	myInt64 start = start_tsc();
+
+	m->steps = train(m->transitionMatrix, m->stateProb, m->emissionMatrix, pb->observations, alpha, beta, gamma, xi, ct, inv_ct, start_symbol, positions, hiddenStates, differentObservables, T, pb->maxSteps);
+
+	m->cycles = stop_tsc(start);
+	memcpy(m->phases, phases, sizeof(phases));
+
+	free(alpha);
+	free(beta);
+	free(gamma);
+	free(xi);
+	free(ct);
+	free(inv_ct);
+	free(start_symbol);
+	free(positions);
+}
+
+const variant bench_cop = {"cop", 1, 1, bench_run};
+
 void heatup(double* const transitionMatrix,double* const piVector,double* const emissionMatrix,const int* const observations,const int hiddenStates,const int differentObservables,const int T){
 
 	double* alpha = (double*) malloc(hiddenStates * T * sizeof(double));
@@ -160,11 +369,15 @@ void heatup(double* const transitionMatrix,double* const piVector,double* const
 	double* xi = (double*) malloc(hiddenStates * hiddenStates * T * sizeof(double));
 	double* ct = (double*) malloc(T * sizeof(double));
 	double* inv_ct = (double*) malloc(T * sizeof(double));
+	int* start = (int*) malloc((differentObservables+1) * sizeof(int));
+	int* positions = (int*) malloc(T * sizeof(int));
+
+	symbolPositions(observations, differentObservables, T, start, positions);
 	
 	for(int j=0;j<10;j++){
 		forward(transitionMatrix, piVector, emissionMatrix, alpha, observations, ct, hiddenStates, differentObservables, T);	
 		backward(transitionMatrix, emissionMatrix, beta, observations, ct, hiddenStates, differentObservables, T);
-		update(transitionMatrix, piVector, emissionMatrix, alpha, beta, gamma, xi, observations, ct, inv_ct, hiddenStates, differentObservables, T);
+		update(transitionMatrix, piVector, emissionMatrix, alpha, beta, gamma, xi, observations, start, positions, ct, inv_ct, hiddenStates, differentObservables, T);
 	}	
 
 	free(alpha);
@@ -173,7 +386,8 @@ void heatup(double* const transitionMatrix,double* const piVector,double* const
 	free(xi);
    	free(ct);
    	free(inv_ct);
-	
+	free(start);
+	free(positions);
 }
 int main(int argc, char *argv[]){
 
@@ -231,6 +445,8 @@ int main(int argc, char *argv[]){
 	double* xi = (double*) malloc(hiddenStates * hiddenStates * (T-1) * sizeof(double)); 
 	double* ct = (double*) malloc(T*sizeof(double));
 	double* inv_ct = (double*) malloc(T*sizeof(double));
+	int* start_symbol = (int*) malloc((differentObservables+1) * sizeof(int));
+	int* positions = (int*) malloc(T * sizeof(int));
 	
 	//random init transition matrix, emission matrix and state probabilities.
 	makeMatrix(hiddenStates, hiddenStates, transitionMatrix);
@@ -247,6 +463,7 @@ int main(int argc, char *argv[]){
 	//matrix for flushing cache
 	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
 	int steps = 0;
+	long totalSteps = 0;
 	
 	for (int run=0; run<maxRuns; run++){
 
@@ -255,163 +472,22 @@ int main(int argc, char *argv[]){
 	   	memcpy(emissionMatrix, emissionMatrixSafe, hiddenStates*differentObservables*sizeof(double));
 	        memcpy(stateProb, stateProbSafe, hiddenStates * sizeof(double));	
 	
-        	double logLikelihood=-DBL_MAX;
-        	double disparance;
-     		steps=0;
         	_flush_cache(buf,BUFSIZE);
 		start = start_tsc();
-		
-		do{
-            		//FORWARD
-
-		        double ct0 = 0.0;
-		        int y0 = observations[0];
-
-		        //compute alpha(0) and scaling factor for t = 0
-		        for(int s = 0; s < hiddenStates; s++){
-			        double alphas = stateProb[s] * emissionMatrix[s*differentObservables + y0];
-			        ct0 += alphas;
-			        alpha[s] = alphas;
-		        }
-		        
-		        ct0 = 1.0 / ct0;
-	
-		        for(int s = 0; s < hiddenStates; s++){
-			        alpha[s] *= ct0;
-		        }
-
-		        ct[0] = ct0;
-	
-		        for(int t = 1; t < T; t++){
-			        double ctt = 0.0;	
-			        const int yt = observations[t];
-			        for(int s = 0; s<hiddenStates; s++){
-				        double alphatNs = 0;
-
-				        for(int j = 0; j < hiddenStates; j++){
-					        alphatNs += alpha[(t-1)*hiddenStates + j] * transitionMatrix[j*hiddenStates + s];
-				        }
-	
-				        alphatNs *= emissionMatrix[s*differentObservables + yt];
-				        ctt += alphatNs;
-				        alpha[t*hiddenStates + s] = alphatNs;
-			        }
- 
-			        ctt = 1.0 / ctt;
-			        
-			        for(int s = 0; s<hiddenStates; s++){
-				        alpha[t*hiddenStates+s] *= ctt;
-			        }
-
-			        ct[t] = ctt;
-		        }	
-	
-		        //BACKWARD
-
-		        double ctT1 = ct[T-1];	
-
-		        for(int s = 0; s < hiddenStates; s++){
-			        beta[(T-1)*hiddenStates + s] = ctT1;
-		        }
-	
-		        for(int t = T-1; t > 0; t--){
-			        const int yt =observations[t];
-			        const double ctt1 = ct[t-1];
-
-			        for(int s = 0; s < hiddenStates; s++){
-				        double betat1Ns = 0;
-
-				        for(int j = 0; j < hiddenStates; j++){
-					        betat1Ns += beta[t*hiddenStates + j ] * transitionMatrix[s*hiddenStates + j] * emissionMatrix[j*differentObservables + yt];
-				        }
-
-				        beta[(t-1)*hiddenStates + s] = ctt1*betat1Ns;
-			        }
-		        }
-	
-        		 //UPDATE
-		        double xi_sum, gamma_sum_numerator, gamma_sum_denominator;
-	
-		        for(int t = 0; t < T; t++){
-			        for(int s = 0; s < hiddenStates; s++){ 
-				        gamma[t*hiddenStates + s] = alpha[t*hiddenStates + s] * beta[t*hiddenStates + s];
-			        }
-		        }
-	
-		        for(int t = 1; t < T; t++){
-			        const int yt = observations[t];
-
-			        for(int s = 0; s < hiddenStates; s++){
-				        const double alphat1Ns = alpha[(t-1)*hiddenStates + s];
-
-				        for(int j = 0; j < hiddenStates; j++){
-					        xi[((t-1) * hiddenStates + s) * hiddenStates + j] = alphat1Ns * transitionMatrix[s*hiddenStates + j] * beta[t*hiddenStates + j] * emissionMatrix[j*differentObservables + yt]; 
-				        }
-			        }
-	       	 }
-
-		        const double ct0div = 1/ct[0];
-		        inv_ct[0] = ct0div;
-
-		        for(int s = 0; s < hiddenStates; s++){
-        	    		stateProb[s] = gamma[s]*ct0div;
-        	    
-			        for(int j = 0; j < hiddenStates; j++){
-				        xi_sum = 0.;
-				        gamma_sum_denominator = 0.;
-
-				        for(int t = 1; t < T; t++){
-					        xi_sum += xi[((t-1) * hiddenStates + s) * hiddenStates + j];	
-					        double inv_ctt1 = 1 / ct[t-1];
-					        inv_ct[t-1] = inv_ctt1;
-					        gamma_sum_denominator += gamma[(t-1)*hiddenStates + s]*inv_ctt1;
-				        }
-
-				        // new transition matrix
-				        transitionMatrix[s*hiddenStates + j] = xi_sum / gamma_sum_denominator;
-			        }
-
-			        double inv_ctt1 = 1/ct[T-1];
-			        inv_ct[T-1]=inv_ctt1;
-			        gamma_sum_denominator += gamma[(T-1)*hiddenStates + s]*inv_ctt1;
-			        const double gamma_sum_denominator_div = 1/gamma_sum_denominator;
-
-			        for(int v = 0; v < differentObservables; v++){
-				        gamma_sum_numerator = 0.;
-
-				        for(int t = 0; t < T; t++){
-					        if(observations[t] == v){
-						        gamma_sum_numerator += gamma[t*hiddenStates + s]*inv_ct[t];
-					        }
-				        }
-
-				        // new emmision matrix
-				        emissionMatrix[s*differentObservables + v] = gamma_sum_numerator * gamma_sum_denominator_div;
-			        }
-		        }
-        		steps+=1;
-	
-		        double oldLogLikelihood=logLikelihood;
-		        double newLogLikelihood = 0.0;
-	
-	        	for(int time = 0; time < T; time++){
-			        newLogLikelihood -= log2(ct[time]);
-	        	}
-	        
-	        	logLikelihood=newLogLikelihood;
-	        	disparance=newLogLikelihood-oldLogLikelihood;
 
-		}while (disparance>EPSILON && steps<maxSteps);
+		steps = train(transitionMatrix, stateProb, emissionMatrix, observations, alpha, beta, gamma, xi, ct, inv_ct, start_symbol, positions, hiddenStates, differentObservables, T, maxSteps);
 
 		cycles = stop_tsc(start);
         	cycles = cycles/steps;
 		runs[run]=cycles;
+		totalSteps+=steps;
 
 	}
 
 	qsort (runs, maxRuns, sizeof (double), compare_doubles);
   	double medianTime = runs[maxRuns/2];
 	printf("Median Time: \t %lf cycles \n", medianTime); 
+	printPhases(phases, totalSteps);
 
 	//write_result(transitionMatrix, emissionMatrix, observations, stateProb, steps, hiddenStates, differentObservables, T);
 		
@@ -452,6 +528,8 @@ int main(int argc, char *argv[]){
 	free(xi);
    	free(ct);
    	free(inv_ct);
+	free(start_symbol);
+	free(positions);
     	free(transitionMatrixSafe);
 	free(emissionMatrixSafe);
    	free(stateProbSafe);
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "tsc_x86.h"
+#include "tested.h"
+#include "util.h"
+#include "bw.h"
+
+double EPSILON = 1e-4;
+//looser than in the double versions, float only has about 7 digits
+#define DELTA 1e-1
+#define BUFSIZE 1<<26
+
+//single precision engine of libbaumwelch (bw-kernels-flt.c) against tested_implementation
+int main(int argc, char *argv[]){
+
+	if(argc < 5){
+		printf("USAGE: ./run <seed> <hiddenStates> <observables> <T> \n");
+		return -1;
+	}
+
+	const int seed = atoi(argv[1]);
+	const int hiddenStates = atoi(argv[2]);
+	const int differentObservables = atoi(argv[3]);
+	const int T = atoi(argv[4]);
+
+	if(argc ==6){
+		int exp = atoi(argv[5]);
+		EPSILON  = pow(10,-exp);
+	}
+
+	myInt64 cycles;
+	myInt64 start;
+	int minima=1;
+	int variableSteps=10-log10(hiddenStates*differentObservables*T);
+	int maxRuns=minima < variableSteps ? variableSteps : minima;
+	double runs[maxRuns];
+
+	srand(seed);
+
+	//ground truth
+	double* groundTransitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+	double* groundEmissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+	makeMatrix(hiddenStates, hiddenStates, groundTransitionMatrix);
+	makeMatrix(hiddenStates, differentObservables, groundEmissionMatrix);
+	int groundInitialState = rand()%hiddenStates;
+	int* observations = (int*) malloc ( T * sizeof(int));
+	makeObservations(hiddenStates, differentObservables, groundInitialState, groundTransitionMatrix,groundEmissionMatrix,T, observations);
+
+	double* transitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+	double* transitionMatrixTesting=(double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+
+	double* emissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+	double* emissionMatrixTesting=(double*) malloc(hiddenStates*differentObservables*sizeof(double));
+
+	double* stateProb  = (double*) malloc(hiddenStates * sizeof(double));
+	double* stateProbTesting  = (double*) malloc(hiddenStates * sizeof(double));
+
+	//random init transition matrix, emission matrix and state probabilities.
+	makeMatrix(hiddenStates, hiddenStates, transitionMatrixTesting);
+	makeMatrix(hiddenStates, differentObservables, emissionMatrixTesting);
+	makeProbabilities(stateProbTesting,hiddenStates);
+
+	bw_model* model = bw_model_create(hiddenStates, differentObservables);
+
+	if(model == NULL){
+		printf("hiddenStates and observables have to be positive \n");
+		return -1;
+	}
+
+	bw_options options;
+	bw_options_init(&options);
+	options.epsilon = EPSILON;
+	options.precision = BW_FLOAT;
+
+	//matrix for flushing cache
+	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
+
+	int steps = 0;
+
+	for (int run=0; run<maxRuns; run++){
+
+		//reset to init
+		bw_model_set(model, transitionMatrixTesting, emissionMatrixTesting, stateProbTesting);
+
+		_flush_cache(buf,BUFSIZE);
+		start = start_tsc();
+
+		steps = bw_train(model, observations, T, &options);
+
+		if(steps < 0){
+			printf("the single precision engine needs AVX2 \n");
+			return -1;
+		}
+
+		cycles = stop_tsc(start);
+		cycles = cycles/steps;
+		runs[run]=cycles;
+	}
+
+	qsort (runs, maxRuns, sizeof (double), compare_doubles);
+	double medianTime = runs[maxRuns/2];
+	printf("Median Time: \t %lf cycles \n", medianTime);
+
+	bw_model_get(model, transitionMatrix, emissionMatrix, stateProb);
+
+	//used for testing
+	tested_implementation(hiddenStates, differentObservables, T, transitionMatrixTesting, emissionMatrixTesting, stateProbTesting, observations,EPSILON, DELTA);
+
+	if (!similar(transitionMatrixTesting,transitionMatrix,hiddenStates,hiddenStates,DELTA) || !similar(emissionMatrixTesting,emissionMatrix,hiddenStates,differentObservables,DELTA)){
+		printf("Something went wrong !");
+	}
+
+	bw_model_free(model);
+	free(groundTransitionMatrix);
+	free(groundEmissionMatrix);
+	free(observations);
+	free(transitionMatrix);
+	free(emissionMatrix);
+	free(stateProb);
+	free(transitionMatrixTesting);
+	free(emissionMatrixTesting);
+	free(stateProbTesting);
+	free((void*)buf);
+
+	return 0;
+}
@@ -0,0 +1,376 @@
+#include <math.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "bw-kernels.h"
+
+//AVX-512 kernels, 8 doubles per register and 8 states per register block.
+//Rows are only 64 byte aligned if N is a multiple of 8, so all accesses are unaligned,
+//the lanes past the end of a row are masked off.
+
+//lanes of the next 8 elements that are still inside a row of length left
+static inline __mmask8 tail_mask(const int left){
+	return left >= 8 ? 0xFF : (__mmask8) ((1u << left) - 1);
+}
+
+//horizontal sums of x0...x7 in the lanes 0...7
+static inline __m512d reduce8(const __m512d x0, const __m512d x1, const __m512d x2, const __m512d x3, const __m512d x4, const __m512d x5, const __m512d x6, const __m512d x7){
+
+	//pairs within each 128 bit lane
+	__m512d x01 = _mm512_add_pd(_mm512_unpacklo_pd(x0, x1), _mm512_unpackhi_pd(x0, x1));
+	__m512d x23 = _mm512_add_pd(_mm512_unpacklo_pd(x2, x3), _mm512_unpackhi_pd(x2, x3));
+	__m512d x45 = _mm512_add_pd(_mm512_unpacklo_pd(x4, x5), _mm512_unpackhi_pd(x4, x5));
+	__m512d x67 = _mm512_add_pd(_mm512_unpacklo_pd(x6, x7), _mm512_unpackhi_pd(x6, x7));
+
+	//even and odd 128 bit lanes
+	__m512d x0123 = _mm512_add_pd(_mm512_shuffle_f64x2(x01, x23, 0x88), _mm512_shuffle_f64x2(x01, x23, 0xDD));
+	__m512d x4567 = _mm512_add_pd(_mm512_shuffle_f64x2(x45, x67, 0x88), _mm512_shuffle_f64x2(x45, x67, 0xDD));
+
+	return _mm512_add_pd(_mm512_shuffle_f64x2(x0123, x4567, 0x88), _mm512_shuffle_f64x2(x0123, x4567, 0xDD));
+}
+
+void v512_forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T){
+
+	const int y0 = y[0];
+	__m512d ct0_vec = _mm512_setzero_pd();
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s+=8){
+		const __mmask8 mask = tail_mask(N - s);
+		__m512d alphas_vec = _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, p + s), _mm512_maskz_loadu_pd(mask, b + y0*N + s));
+		ct0_vec = _mm512_add_pd(ct0_vec, alphas_vec);
+		_mm512_mask_storeu_pd(alpha + s, mask, alphas_vec);
+	}
+
+	ct[0] = 1.0 / _mm512_reduce_add_pd(ct0_vec);
+	__m512d ct0_vec_div = _mm512_set1_pd(ct[0]);
+
+	for(int s = 0; s < N; s+=8){
+		const __mmask8 mask = tail_mask(N - s);
+		_mm512_mask_storeu_pd(alpha + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, alpha + s), ct0_vec_div));
+	}
+
+	v512_forward_steps(a, b, y, alpha, alpha + N, ct, N, 1, T);
+}
+
+void v512_forward_steps(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last){
+
+	const double* alpha_prev = start;
+
+	//compute alpha(t)
+	for(int t = first; t < last; t++){
+		double* const alpha_cur = alpha + (size_t)(t-first)*N;
+		__m512d ctt_vec = _mm512_setzero_pd();
+		const int yt = y[t];
+
+		for(int s = 0; s < N; s+=8){
+			const __mmask8 smask = tail_mask(N - s);
+
+			//a last block of 4 states computes rows s...s+3 twice and drops the copies
+			const int high = N - s >= 8 ? 4 : 0;
+
+			const double* const a0 = a + s*N;
+			const double* const a1 = a + (s+1)*N;
+			const double* const a2 = a + (s+2)*N;
+			const double* const a3 = a + (s+3)*N;
+			const double* const a4 = a + (s+high)*N;
+			const double* const a5 = a + (s+high+1)*N;
+			const double* const a6 = a + (s+high+2)*N;
+			const double* const a7 = a + (s+high+3)*N;
+
+			__m512d alphatNs0 = _mm512_setzero_pd();
+			__m512d alphatNs1 = _mm512_setzero_pd();
+			__m512d alphatNs2 = _mm512_setzero_pd();
+			__m512d alphatNs3 = _mm512_setzero_pd();
+			__m512d alphatNs4 = _mm512_setzero_pd();
+			__m512d alphatNs5 = _mm512_setzero_pd();
+			__m512d alphatNs6 = _mm512_setzero_pd();
+			__m512d alphatNs7 = _mm512_setzero_pd();
+
+			for(int j = 0; j < N; j+=8){
+				const __mmask8 jmask = tail_mask(N - j);
+				__m512d alphaFactor = _mm512_maskz_loadu_pd(jmask, alpha_prev + j);
+
+				alphatNs0 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a0 + j), alphatNs0);
+				alphatNs1 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a1 + j), alphatNs1);
+				alphatNs2 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a2 + j), alphatNs2);
+				alphatNs3 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a3 + j), alphatNs3);
+				alphatNs4 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a4 + j), alphatNs4);
+				alphatNs5 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a5 + j), alphatNs5);
+				alphatNs6 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a6 + j), alphatNs6);
+				alphatNs7 = _mm512_fmadd_pd(alphaFactor, _mm512_maskz_loadu_pd(jmask, a7 + j), alphatNs7);
+			}
+
+			__m512d alpha_tot = reduce8(alphatNs0, alphatNs1, alphatNs2, alphatNs3, alphatNs4, alphatNs5, alphatNs6, alphatNs7);
+			__m512d alpha_tot_mul = _mm512_mul_pd(alpha_tot, _mm512_maskz_loadu_pd(smask, b + yt*N + s));
+
+			ctt_vec = _mm512_add_pd(ctt_vec, alpha_tot_mul);
+
+			_mm512_mask_storeu_pd(alpha_cur + s, smask, alpha_tot_mul);
+		}
+
+		ct[t] = 1.0 / _mm512_reduce_add_pd(ctt_vec);
+		__m512d ctt_vec_div = _mm512_set1_pd(ct[t]);
+
+		for(int s = 0; s < N; s+=8){
+			const __mmask8 mask = tail_mask(N - s);
+			_mm512_mask_storeu_pd(alpha_cur + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, alpha_cur + s), ctt_vec_div));
+		}
+
+		alpha_prev = alpha_cur;
+	}
+}
+
+void v512_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T){
+
+	v512_backward_init(alpha + (size_t)(T-1)*N, ct, y, beta, gamma0, gamma_T, b_new, N, T);
+	v512_backward_steps(ab, alpha, ct, y, beta, beta_new, gamma0, gamma_sum, a_new, b_new, N, 0, T-1);
+	vec_add(p_new, gamma0, 1, N);
+}
+
+void v512_backward_init(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T){
+
+	__m512d ctT_vec = _mm512_set1_pd(ct[T-1]);
+	const int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s+=8){
+		const __mmask8 mask = tail_mask(N - s);
+		__m512d alphaT1Ns = _mm512_maskz_loadu_pd(mask, alphaT1 + s);
+
+		_mm512_mask_storeu_pd(beta + s, mask, ctT_vec);
+		_mm512_mask_storeu_pd(gamma0 + s, mask, alphaT1Ns);
+		_mm512_mask_storeu_pd(gamma_T + s, mask, _mm512_add_pd(_mm512_maskz_loadu_pd(mask, gamma_T + s), alphaT1Ns));
+		_mm512_mask_storeu_pd(b_new + yt*N + s, mask, _mm512_add_pd(_mm512_maskz_loadu_pd(mask, b_new + yt*N + s), alphaT1Ns));
+	}
+}
+
+//fused backward and update step for the 8 states s...s+7
+//adds their xi to a_new and returns their beta_new (unscaled)
+static inline __m512d backward_block8(const double* const abt, const double* const alphat1, const double* const beta_cur, double* const a_new, const int s, const int N){
+
+	__m512d alphat1Ns0 = _mm512_set1_pd(alphat1[s]);
+	__m512d alphat1Ns1 = _mm512_set1_pd(alphat1[s+1]);
+	__m512d alphat1Ns2 = _mm512_set1_pd(alphat1[s+2]);
+	__m512d alphat1Ns3 = _mm512_set1_pd(alphat1[s+3]);
+	__m512d alphat1Ns4 = _mm512_set1_pd(alphat1[s+4]);
+	__m512d alphat1Ns5 = _mm512_set1_pd(alphat1[s+5]);
+	__m512d alphat1Ns6 = _mm512_set1_pd(alphat1[s+6]);
+	__m512d alphat1Ns7 = _mm512_set1_pd(alphat1[s+7]);
+
+	__m512d beta_news0 = _mm512_setzero_pd();
+	__m512d beta_news1 = _mm512_setzero_pd();
+	__m512d beta_news2 = _mm512_setzero_pd();
+	__m512d beta_news3 = _mm512_setzero_pd();
+	__m512d beta_news4 = _mm512_setzero_pd();
+	__m512d beta_news5 = _mm512_setzero_pd();
+	__m512d beta_news6 = _mm512_setzero_pd();
+	__m512d beta_news7 = _mm512_setzero_pd();
+
+	for(int j = 0; j < N; j+=8){
+		const __mmask8 jmask = tail_mask(N - j);
+		__m512d beta_vec = _mm512_maskz_loadu_pd(jmask, beta_cur + j);
+
+		__m512d temp0 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + s*N + j), beta_vec);
+		__m512d temp1 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+1)*N + j), beta_vec);
+		__m512d temp2 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+2)*N + j), beta_vec);
+		__m512d temp3 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+3)*N + j), beta_vec);
+		__m512d temp4 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+4)*N + j), beta_vec);
+		__m512d temp5 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+5)*N + j), beta_vec);
+		__m512d temp6 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+6)*N + j), beta_vec);
+		__m512d temp7 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+7)*N + j), beta_vec);
+
+		_mm512_mask_storeu_pd(a_new + s*N + j, jmask, _mm512_fmadd_pd(alphat1Ns0, temp0, _mm512_maskz_loadu_pd(jmask, a_new + s*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+1)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns1, temp1, _mm512_maskz_loadu_pd(jmask, a_new + (s+1)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+2)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns2, temp2, _mm512_maskz_loadu_pd(jmask, a_new + (s+2)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+3)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns3, temp3, _mm512_maskz_loadu_pd(jmask, a_new + (s+3)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+4)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns4, temp4, _mm512_maskz_loadu_pd(jmask, a_new + (s+4)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+5)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns5, temp5, _mm512_maskz_loadu_pd(jmask, a_new + (s+5)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+6)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns6, temp6, _mm512_maskz_loadu_pd(jmask, a_new + (s+6)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+7)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns7, temp7, _mm512_maskz_loadu_pd(jmask, a_new + (s+7)*N + j)));
+
+		beta_news0 = _mm512_add_pd(beta_news0, temp0);
+		beta_news1 = _mm512_add_pd(beta_news1, temp1);
+		beta_news2 = _mm512_add_pd(beta_news2, temp2);
+		beta_news3 = _mm512_add_pd(beta_news3, temp3);
+		beta_news4 = _mm512_add_pd(beta_news4, temp4);
+		beta_news5 = _mm512_add_pd(beta_news5, temp5);
+		beta_news6 = _mm512_add_pd(beta_news6, temp6);
+		beta_news7 = _mm512_add_pd(beta_news7, temp7);
+	}
+
+	return reduce8(beta_news0, beta_news1, beta_news2, beta_news3, beta_news4, beta_news5, beta_news6, beta_news7);
+}
+
+//same for the last 4 states s...s+3 if N is not a multiple of 8 (lanes 4...7 of the result are 0)
+static inline __m512d backward_block4(const double* const abt, const double* const alphat1, const double* const beta_cur, double* const a_new, const int s, const int N){
+
+	__m512d alphat1Ns0 = _mm512_set1_pd(alphat1[s]);
+	__m512d alphat1Ns1 = _mm512_set1_pd(alphat1[s+1]);
+	__m512d alphat1Ns2 = _mm512_set1_pd(alphat1[s+2]);
+	__m512d alphat1Ns3 = _mm512_set1_pd(alphat1[s+3]);
+
+	__m512d beta_news0 = _mm512_setzero_pd();
+	__m512d beta_news1 = _mm512_setzero_pd();
+	__m512d beta_news2 = _mm512_setzero_pd();
+	__m512d beta_news3 = _mm512_setzero_pd();
+	__m512d zero = _mm512_setzero_pd();
+
+	for(int j = 0; j < N; j+=8){
+		const __mmask8 jmask = tail_mask(N - j);
+		__m512d beta_vec = _mm512_maskz_loadu_pd(jmask, beta_cur + j);
+
+		__m512d temp0 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + s*N + j), beta_vec);
+		__m512d temp1 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+1)*N + j), beta_vec);
+		__m512d temp2 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+2)*N + j), beta_vec);
+		__m512d temp3 = _mm512_mul_pd(_mm512_maskz_loadu_pd(jmask, abt + (s+3)*N + j), beta_vec);
+
+		_mm512_mask_storeu_pd(a_new + s*N + j, jmask, _mm512_fmadd_pd(alphat1Ns0, temp0, _mm512_maskz_loadu_pd(jmask, a_new + s*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+1)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns1, temp1, _mm512_maskz_loadu_pd(jmask, a_new + (s+1)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+2)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns2, temp2, _mm512_maskz_loadu_pd(jmask, a_new + (s+2)*N + j)));
+		_mm512_mask_storeu_pd(a_new + (s+3)*N + j, jmask, _mm512_fmadd_pd(alphat1Ns3, temp3, _mm512_maskz_loadu_pd(jmask, a_new + (s+3)*N + j)));
+
+		beta_news0 = _mm512_add_pd(beta_news0, temp0);
+		beta_news1 = _mm512_add_pd(beta_news1, temp1);
+		beta_news2 = _mm512_add_pd(beta_news2, temp2);
+		beta_news3 = _mm512_add_pd(beta_news3, temp3);
+	}
+
+	return reduce8(beta_news0, beta_news1, beta_news2, beta_news3, zero, zero, zero, zero);
+}
+
+//one step of v512_backward_steps, abt is the N x N block of a*b of the current observation
+static void backward_step(const double* const abt, const double* const alphat1, const double ctt, const int yt1, const double* const beta_cur, double* const beta_nxt, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N){
+
+	__m512d ctt_vec = _mm512_set1_pd(ctt);
+
+	for(int s = 0; s < N; s+=8){
+		const __mmask8 smask = tail_mask(N - s);
+
+		__m512d beta_news = N - s >= 8 ? backward_block8(abt, alphat1, beta_cur, a_new, s, N) : backward_block4(abt, alphat1, beta_cur, a_new, s, N);
+		__m512d ps = _mm512_mul_pd(_mm512_maskz_loadu_pd(smask, alphat1 + s), beta_news);
+
+		_mm512_mask_storeu_pd(gamma0 + s, smask, ps);
+		_mm512_mask_storeu_pd(beta_nxt + s, smask, _mm512_mul_pd(beta_news, ctt_vec));
+		_mm512_mask_storeu_pd(gamma_sum + s, smask, _mm512_add_pd(_mm512_maskz_loadu_pd(smask, gamma_sum + s), ps));
+		_mm512_mask_storeu_pd(b_new + yt1*N + s, smask, _mm512_add_pd(_mm512_maskz_loadu_pd(smask, b_new + yt1*N + s), ps));
+	}
+}
+
+void v512_backward_steps(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	int yt = y[last];
+
+	for(int t = last; t > first; t--){
+		const int yt1 = y[t-1];
+
+		backward_step(ab + yt*N*N, alpha + (size_t)(t-1-first)*N, ct[t-1], yt1, beta_cur, beta_nxt, gamma0, gamma_sum, a_new, b_new, N);
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	//leave beta(first) in beta
+	if(beta_cur != beta){
+		memcpy(beta, beta_cur, N * sizeof(double));
+	}
+}
+
+void v512_backward_steps_otf(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	int yt = y[last];
+
+	for(int t = last; t > first; t--){
+		const int yt1 = y[t-1];
+
+		//fold b(yt) into beta instead of into a
+		for(int j = 0; j < N; j+=8){
+			const __mmask8 mask = tail_mask(N - j);
+			_mm512_mask_storeu_pd(beta_cur + j, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, beta_cur + j), _mm512_maskz_loadu_pd(mask, b + yt*N + j)));
+		}
+
+		backward_step(a, alpha + (size_t)(t-1-first)*N, ct[t-1], yt1, beta_cur, beta_nxt, gamma0, gamma_sum, a_new, b_new, N);
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	//leave beta(first) in beta
+	if(beta_cur != beta){
+		memcpy(beta, beta_cur, N * sizeof(double));
+	}
+}
+
+void v512_update(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K){
+
+	__m512d one = _mm512_set1_pd(1.0);
+	__m512d sequences_inv = _mm512_set1_pd(1.0 / sequences);
+
+	//add remaining parts of the sum of gamma
+	for(int s = 0; s < N; s+=8){
+		const __mmask8 mask = tail_mask(N - s);
+		__m512d gamma_Ts = _mm512_maskz_loadu_pd(mask, gamma_T + s);
+		__m512d gamma_sums = _mm512_maskz_loadu_pd(mask, gamma_sum + s);
+
+		_mm512_mask_storeu_pd(gamma_T + s, mask, _mm512_div_pd(one, _mm512_add_pd(gamma_Ts, gamma_sums)));
+		_mm512_mask_storeu_pd(gamma_sum + s, mask, _mm512_div_pd(one, gamma_sums));
+		_mm512_mask_storeu_pd(p + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, p_new + s), sequences_inv));
+	}
+
+	//compute new transition matrix
+	for(int s = 0; s < N; s++){
+		__m512d gamma_inv = _mm512_set1_pd(gamma_sum[s]);
+
+		for(int j = 0; j < N; j+=8){
+			const __mmask8 mask = tail_mask(N - j);
+			_mm512_mask_storeu_pd(a + s*N + j, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a_new + s*N + j), gamma_inv));
+		}
+	}
+
+	//compute new emission matrix, 4 observables per block
+	for(int v = 0; v < K; v+=4){
+		for(int s = 0; s < N; s+=8){
+			const __mmask8 mask = tail_mask(N - s);
+			__m512d gamma_Tv = _mm512_maskz_loadu_pd(mask, gamma_T + s);
+
+			_mm512_mask_storeu_pd(b + v*N + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b_new + v*N + s), gamma_Tv));
+			_mm512_mask_storeu_pd(b + (v+1)*N + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b_new + (v+1)*N + s), gamma_Tv));
+			_mm512_mask_storeu_pd(b + (v+2)*N + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b_new + (v+2)*N + s), gamma_Tv));
+			_mm512_mask_storeu_pd(b + (v+3)*N + s, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b_new + (v+3)*N + s), gamma_Tv));
+		}
+	}
+}
+
+//the transposes, ab, the chunks of the time parallel forward step and the mixed precision kernels stay on AVX2
+const kernels v512_kernels = {
+	.name = "avx512",
+	.simd = 1,
+	.transpose = vec_transpose,
+	.forward = v512_forward,
+	.forward_steps = v512_forward_steps,
+	.chunk_product = vec_chunk_product,
+	.stitch = vec_stitch,
+	.build_ab = vec_build_ab,
+	.backward = v512_backward,
+	.backward_init = v512_backward_init,
+	.backward_steps = v512_backward_steps,
+	.backward_steps_otf = v512_backward_steps_otf,
+	.backward_blocked = vec_backward_blocked,
+	.update = v512_update,
+	.zero = vec_zero,
+	.add = vec_add,
+	.log_likelihood = vec_log_likelihood,
+	.mix_forward = mix_forward,
+	.mix_backward = mix_backward,
+	.logarithm = vec_logarithm,
+	.log_forward = vec_log_forward,
+	.log_backward = vec_log_backward
+};
@@ -0,0 +1,226 @@
+#include <math.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "bw-kernels.h"
+
+//Banded transition kernels, a is kept as its diagonals k = -lower...upper:
+//diag[(k+lower)*N + s] = a(s, s+k), only the entries with 0 <= s+k < N are used.
+//The loops run along the diagonals, 4 states per register with unaligned loads (s+k is not aligned)
+//and a scalar remainder at the end of the shorter diagonals.
+
+//horizontal sum of the four lanes, broadcasted into all lanes
+static inline __m256d reduce_vec(const __m256d x){
+
+	__m256d perm = _mm256_permute2f128_pd(x,x,0b00000011);
+
+	__m256d shuffle1 = _mm256_shuffle_pd(x, perm, 0b0101);
+	__m256d shuffle2 = _mm256_shuffle_pd(perm, x, 0b0101);
+
+	__m256d x_add = _mm256_add_pd(x, perm);
+	__m256d x_temp = _mm256_add_pd(shuffle1, shuffle2);
+
+	return _mm256_add_pd(x_add, x_temp);
+}
+
+//states s of diagonal k with 0 <= s+k < N
+static inline int first_state(const int k){
+	return k < 0 ? -k : 0;
+}
+
+static inline int last_state(const int k, const int N){
+	return k > 0 ? N - k : N;
+}
+
+//ab[((v*(lower+upper+1) + k+lower)*N + s] = a(s, s+k) * b(v, s+k)
+void band_build(const double* const diag, const double* const b, double* const ab, const int lower, const int upper, const int N, const int K){
+
+	const int bands = lower + upper + 1;
+
+	for(int v = 0; v < K; v++){
+		for(int k = -lower; k <= upper; k++){
+			const double* const d = diag + (k+lower)*N;
+			const double* const bv = b + v*N + k;
+			double* const abvk = ab + (v*bands + k+lower)*N;
+			const int last = last_state(k, N);
+			int s = first_state(k);
+
+			for(; s + 4 <= last; s+=4){
+				_mm256_storeu_pd(abvk + s, _mm256_mul_pd(_mm256_loadu_pd(d + s), _mm256_loadu_pd(bv + s)));
+			}
+
+			for(; s < last; s++){
+				abvk[s] = d[s] * bv[s];
+			}
+		}
+	}
+}
+
+void band_forward(const double* const diag, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int lower, const int upper, const int N, const int T){
+
+	__m256d one = _mm256_set1_pd(1.0);
+	const int y0 = y[0];
+	__m256d ct0_vec = _mm256_setzero_pd();
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s+=4){
+		__m256d alphas = _mm256_mul_pd(_mm256_load_pd(p + s), _mm256_load_pd(b + y0*N + s));
+		ct0_vec = _mm256_add_pd(ct0_vec, alphas);
+		_mm256_store_pd(alpha + s, alphas);
+	}
+
+	__m256d ct0_div = _mm256_div_pd(one, reduce_vec(ct0_vec));
+	ct[0] = _mm256_cvtsd_f64(ct0_div);
+
+	for(int s = 0; s < N; s+=4){
+		_mm256_store_pd(alpha + s, _mm256_mul_pd(_mm256_load_pd(alpha + s), ct0_div));
+	}
+
+	//compute alpha(t), diagonal k moves alpha(t-1)(s) to alpha(t)(s+k)
+	for(int t = 1; t < T; t++){
+		const double* const alpha_prev = alpha + (size_t)(t-1)*N;
+		double* const alpha_cur = alpha + (size_t)t*N;
+		const int yt = y[t];
+		__m256d ctt_vec = _mm256_setzero_pd();
+
+		for(int s = 0; s < N; s+=4){
+			_mm256_store_pd(alpha_cur + s, _mm256_setzero_pd());
+		}
+
+		for(int k = -lower; k <= upper; k++){
+			const double* const d = diag + (k+lower)*N;
+			double* const target = alpha_cur + k;
+			const int last = last_state(k, N);
+			int s = first_state(k);
+
+			for(; s + 4 <= last; s+=4){
+				_mm256_storeu_pd(target + s, _mm256_fmadd_pd(_mm256_loadu_pd(alpha_prev + s), _mm256_loadu_pd(d + s), _mm256_loadu_pd(target + s)));
+			}
+
+			for(; s < last; s++){
+				target[s] += alpha_prev[s] * d[s];
+			}
+		}
+
+		for(int s = 0; s < N; s+=4){
+			__m256d alphas = _mm256_mul_pd(_mm256_load_pd(alpha_cur + s), _mm256_load_pd(b + yt*N + s));
+			ctt_vec = _mm256_add_pd(ctt_vec, alphas);
+			_mm256_store_pd(alpha_cur + s, alphas);
+		}
+
+		__m256d ctt_div = _mm256_div_pd(one, reduce_vec(ctt_vec));
+		ct[t] = _mm256_cvtsd_f64(ctt_div);
+
+		for(int s = 0; s < N; s+=4){
+			_mm256_store_pd(alpha_cur + s, _mm256_mul_pd(_mm256_load_pd(alpha_cur + s), ctt_div));
+		}
+	}
+}
+
+void band_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int lower, const int upper, const int N, const int T){
+
+	const int bands = lower + upper + 1;
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	__m256d ctT_vec = _mm256_set1_pd(ct[T-1]);
+	int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s+=4){
+		__m256d alphaT1Ns = _mm256_load_pd(alpha + (size_t)(T-1)*N + s);
+
+		_mm256_store_pd(beta_cur + s, ctT_vec);
+		_mm256_store_pd(gamma0 + s, alphaT1Ns);
+		_mm256_store_pd(gamma_T + s, _mm256_add_pd(_mm256_load_pd(gamma_T + s), alphaT1Ns));
+		_mm256_store_pd(b_new + yt*N + s, _mm256_add_pd(_mm256_load_pd(b_new + yt*N + s), alphaT1Ns));
+	}
+
+	for(int t = T-1; t > 0; t--){
+		const double* const alphat1 = alpha + (size_t)(t-1)*N;
+		__m256d ctt_vec = _mm256_set1_pd(ct[t-1]);
+		const int yt1 = y[t-1];
+
+		for(int s = 0; s < N; s+=4){
+			_mm256_store_pd(beta_nxt + s, _mm256_setzero_pd());
+		}
+
+		//xi(t-1)(s, s+k) = alpha(t-1)(s) * ab(s, s+k) * beta(t)(s+k), only on the band
+		for(int k = -lower; k <= upper; k++){
+			const double* const abk = ab + (yt*bands + k+lower)*N;
+			const double* const source = beta_cur + k;
+			double* const a_newk = a_new + (k+lower)*N;
+			const int last = last_state(k, N);
+			int s = first_state(k);
+
+			for(; s + 4 <= last; s+=4){
+				__m256d temp = _mm256_mul_pd(_mm256_loadu_pd(abk + s), _mm256_loadu_pd(source + s));
+				_mm256_storeu_pd(a_newk + s, _mm256_fmadd_pd(_mm256_loadu_pd(alphat1 + s), temp, _mm256_loadu_pd(a_newk + s)));
+				_mm256_storeu_pd(beta_nxt + s, _mm256_add_pd(_mm256_loadu_pd(beta_nxt + s), temp));
+			}
+
+			for(; s < last; s++){
+				double temp = abk[s] * source[s];
+				a_newk[s] += alphat1[s] * temp;
+				beta_nxt[s] += temp;
+			}
+		}
+
+		for(int s = 0; s < N; s+=4){
+			__m256d beta_news = _mm256_load_pd(beta_nxt + s);
+			__m256d ps = _mm256_mul_pd(_mm256_load_pd(alphat1 + s), beta_news);
+
+			_mm256_store_pd(gamma0 + s, ps);
+			_mm256_store_pd(beta_nxt + s, _mm256_mul_pd(beta_news, ctt_vec));
+			_mm256_store_pd(gamma_sum + s, _mm256_add_pd(_mm256_load_pd(gamma_sum + s), ps));
+			_mm256_store_pd(b_new + yt1*N + s, _mm256_add_pd(_mm256_load_pd(b_new + yt1*N + s), ps));
+		}
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	for(int s = 0; s < N; s+=4){
+		_mm256_store_pd(p_new + s, _mm256_add_pd(_mm256_load_pd(p_new + s), _mm256_load_pd(gamma0 + s)));
+	}
+}
+
+void band_update(double* const diag, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int lower, const int upper, const int N, const int K){
+
+	__m256d one = _mm256_set1_pd(1.0);
+	__m256d sequences_inv = _mm256_set1_pd(1.0 / sequences);
+
+	//add remaining parts of the sum of gamma
+	for(int s = 0; s < N; s+=4){
+		__m256d gamma_Ts = _mm256_load_pd(gamma_T + s);
+		__m256d gamma_sums = _mm256_load_pd(gamma_sum + s);
+
+		_mm256_store_pd(gamma_T + s, _mm256_div_pd(one, _mm256_add_pd(gamma_Ts, gamma_sums)));
+		_mm256_store_pd(gamma_sum + s, _mm256_div_pd(one, gamma_sums));
+		_mm256_store_pd(p + s, _mm256_mul_pd(_mm256_load_pd(p_new + s), sequences_inv));
+	}
+
+	//compute the new band of the transition matrix
+	for(int k = -lower; k <= upper; k++){
+		double* const d = diag + (k+lower)*N;
+		const double* const a_newk = a_new + (k+lower)*N;
+		const int last = last_state(k, N);
+		int s = first_state(k);
+
+		for(; s + 4 <= last; s+=4){
+			_mm256_storeu_pd(d + s, _mm256_mul_pd(_mm256_loadu_pd(a_newk + s), _mm256_loadu_pd(gamma_sum + s)));
+		}
+
+		for(; s < last; s++){
+			d[s] = a_newk[s] * gamma_sum[s];
+		}
+	}
+
+	//compute new emission matrix
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s+=4){
+			_mm256_store_pd(b + v*N + s, _mm256_mul_pd(_mm256_load_pd(b_new + v*N + s), _mm256_load_pd(gamma_T + s)));
+		}
+	}
+}
@@ -0,0 +1,145 @@
+#include <math.h>
+#include <string.h>
+
+#include "bw-kernels.h"
+
+//Sparse transition kernels, only the nonzeros of a in compressed sparse row format:
+//the nonzeros of row s are val[row[s]...row[s+1]-1] in the columns col[...].
+//Plain scalar loops, the rows are a handful of entries long, too short for gathers to pay off.
+
+void csr_build(const double* const val, const int* const col, const int* const tpos, const double* const b, double* const tval, double* const ab, const int nnz, const int N, const int K){
+
+	//values of the transposed
+	for(int k = 0; k < nnz; k++){
+		tval[tpos[k]] = val[k];
+	}
+
+	//ab[v*nnz + k] = a(s,j) * b(v,j) of nonzero k = (s,j)
+	for(int v = 0; v < K; v++){
+		for(int k = 0; k < nnz; k++){
+			ab[v*nnz + k] = val[k] * b[v*N + col[k]];
+		}
+	}
+}
+
+void csr_forward(const int* const trow, const int* const tcol, const double* const tval, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T){
+
+	const int y0 = y[0];
+	double ct0 = 0.0;
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s++){
+		alpha[s] = p[s] * b[y0*N + s];
+		ct0 += alpha[s];
+	}
+
+	ct0 = 1.0 / ct0;
+	ct[0] = ct0;
+
+	for(int s = 0; s < N; s++){
+		alpha[s] *= ct0;
+	}
+
+	//compute alpha(t), row s of the transposed holds the predecessors of s
+	for(int t = 1; t < T; t++){
+		const double* const alpha_prev = alpha + (size_t)(t-1)*N;
+		double* const alpha_cur = alpha + (size_t)t*N;
+		const int yt = y[t];
+		double ctt = 0.0;
+
+		for(int s = 0; s < N; s++){
+			double alphatNs = 0.0;
+
+			for(int k = trow[s]; k < trow[s+1]; k++){
+				alphatNs += alpha_prev[tcol[k]] * tval[k];
+			}
+
+			alphatNs *= b[yt*N + s];
+			alpha_cur[s] = alphatNs;
+			ctt += alphatNs;
+		}
+
+		ctt = 1.0 / ctt;
+		ct[t] = ctt;
+
+		for(int s = 0; s < N; s++){
+			alpha_cur[s] *= ctt;
+		}
+	}
+}
+
+void csr_backward(const int* const row, const int* const col, const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int nnz, const int N, const int T){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	const double ctT = ct[T-1];
+	int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s++){
+		const double alphaT1Ns = alpha[(size_t)(T-1)*N + s];
+		beta_cur[s] = ctT;
+		gamma0[s] = alphaT1Ns;
+		gamma_T[s] += alphaT1Ns;
+		b_new[yt*N + s] += alphaT1Ns;
+	}
+
+	for(int t = T-1; t > 0; t--){
+		const double* const abt = ab + yt*nnz;
+		const double* const alphat1 = alpha + (size_t)(t-1)*N;
+		const double ctt = ct[t-1];
+		const int yt1 = y[t-1];
+
+		for(int s = 0; s < N; s++){
+			const double alphat1Ns = alphat1[s];
+			double beta_news = 0.0;
+
+			//xi only on the nonzeros, the zeros of a stay zero
+			for(int k = row[s]; k < row[s+1]; k++){
+				double temp = abt[k] * beta_cur[col[k]];
+				a_new[k] += alphat1Ns * temp;
+				beta_news += temp;
+			}
+
+			double ps = alphat1Ns * beta_news;
+
+			gamma0[s] = ps;
+			beta_nxt[s] = beta_news * ctt;
+			gamma_sum[s] += ps;
+			b_new[yt1*N + s] += ps;
+		}
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	for(int s = 0; s < N; s++){
+		p_new[s] += gamma0[s];
+	}
+}
+
+void csr_update(double* const val, const int* const row, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K){
+
+	//add remaining parts of the sum of gamma
+	for(int s = 0; s < N; s++){
+		gamma_T[s] = 1.0 / (gamma_T[s] + gamma_sum[s]);
+		gamma_sum[s] = 1.0 / gamma_sum[s];
+		p[s] = p_new[s] / sequences;
+	}
+
+	//compute the new nonzeros of the transition matrix
+	for(int s = 0; s < N; s++){
+		for(int k = row[s]; k < row[s+1]; k++){
+			val[k] = a_new[k] * gamma_sum[s];
+		}
+	}
+
+	//compute new emission matrix
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s++){
+			b[v*N + s] = b_new[v*N + s] * gamma_T[s];
+		}
+	}
+}
@@ -0,0 +1,366 @@
+#include <math.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "bw-kernels.h"
+
+//horizontal sum of the eight lanes
+static inline float reduce_flt(const __m256 x){
+
+	__m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+	__m128 sum2 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+	__m128 sum1 = _mm_add_ss(sum2, _mm_movehdup_ps(sum2));
+
+	return _mm_cvtss_f32(sum1);
+}
+
+//horizontal sums of x0...x7 in the lanes 0...7
+static inline __m256 reduce8_flt(const __m256 x0, const __m256 x1, const __m256 x2, const __m256 x3, const __m256 x4, const __m256 x5, const __m256 x6, const __m256 x7){
+
+	__m256 x01 = _mm256_hadd_ps(x0, x1);
+	__m256 x23 = _mm256_hadd_ps(x2, x3);
+	__m256 x45 = _mm256_hadd_ps(x4, x5);
+	__m256 x67 = _mm256_hadd_ps(x6, x7);
+
+	__m256 x0123 = _mm256_hadd_ps(x01, x23);
+	__m256 x4567 = _mm256_hadd_ps(x45, x67);
+
+	__m256 low = _mm256_permute2f128_ps(x0123, x4567, 0x20);
+	__m256 high = _mm256_permute2f128_ps(x0123, x4567, 0x31);
+
+	return _mm256_add_ps(low, high);
+}
+
+//horizontal sums of x0...x3 in the lanes 0...3
+static inline __m128 reduce4_flt(const __m256 x0, const __m256 x1, const __m256 x2, const __m256 x3){
+
+	__m256 x01 = _mm256_hadd_ps(x0, x1);
+	__m256 x23 = _mm256_hadd_ps(x2, x3);
+	__m256 x0123 = _mm256_hadd_ps(x01, x23);
+
+	return _mm_add_ps(_mm256_castps256_ps128(x0123), _mm256_extractf128_ps(x0123, 1));
+}
+
+//transpose of the 8x8 block in r0...r7
+static inline void transpose8_flt(__m256* const r0, __m256* const r1, __m256* const r2, __m256* const r3, __m256* const r4, __m256* const r5, __m256* const r6, __m256* const r7){
+
+	__m256 t0 = _mm256_unpacklo_ps(*r0, *r1);
+	__m256 t1 = _mm256_unpackhi_ps(*r0, *r1);
+	__m256 t2 = _mm256_unpacklo_ps(*r2, *r3);
+	__m256 t3 = _mm256_unpackhi_ps(*r2, *r3);
+	__m256 t4 = _mm256_unpacklo_ps(*r4, *r5);
+	__m256 t5 = _mm256_unpackhi_ps(*r4, *r5);
+	__m256 t6 = _mm256_unpacklo_ps(*r6, *r7);
+	__m256 t7 = _mm256_unpackhi_ps(*r6, *r7);
+
+	__m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+	__m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+	__m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+	__m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+	__m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+	__m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+	__m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+	__m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+	*r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+	*r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+	*r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+	*r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+	*r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+	*r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+	*r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+	*r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+void flt_transpose(float* const a, const int N){
+
+	for(int by = 0; by < N; by+=8){
+
+		//Diagonal block
+		__m256 diag0 = _mm256_load_ps(a + by*N + by);
+		__m256 diag1 = _mm256_load_ps(a + (by+1)*N + by);
+		__m256 diag2 = _mm256_load_ps(a + (by+2)*N + by);
+		__m256 diag3 = _mm256_load_ps(a + (by+3)*N + by);
+		__m256 diag4 = _mm256_load_ps(a + (by+4)*N + by);
+		__m256 diag5 = _mm256_load_ps(a + (by+5)*N + by);
+		__m256 diag6 = _mm256_load_ps(a + (by+6)*N + by);
+		__m256 diag7 = _mm256_load_ps(a + (by+7)*N + by);
+
+		transpose8_flt(&diag0, &diag1, &diag2, &diag3, &diag4, &diag5, &diag6, &diag7);
+
+		_mm256_store_ps(a + by*N + by, diag0);
+		_mm256_store_ps(a + (by+1)*N + by, diag1);
+		_mm256_store_ps(a + (by+2)*N + by, diag2);
+		_mm256_store_ps(a + (by+3)*N + by, diag3);
+		_mm256_store_ps(a + (by+4)*N + by, diag4);
+		_mm256_store_ps(a + (by+5)*N + by, diag5);
+		_mm256_store_ps(a + (by+6)*N + by, diag6);
+		_mm256_store_ps(a + (by+7)*N + by, diag7);
+
+		//Offdiagonal blocks
+		for(int bx = by + 8; bx < N; bx+=8){
+
+			__m256 upper0 = _mm256_load_ps(a + by*N + bx);
+			__m256 upper1 = _mm256_load_ps(a + (by+1)*N + bx);
+			__m256 upper2 = _mm256_load_ps(a + (by+2)*N + bx);
+			__m256 upper3 = _mm256_load_ps(a + (by+3)*N + bx);
+			__m256 upper4 = _mm256_load_ps(a + (by+4)*N + bx);
+			__m256 upper5 = _mm256_load_ps(a + (by+5)*N + bx);
+			__m256 upper6 = _mm256_load_ps(a + (by+6)*N + bx);
+			__m256 upper7 = _mm256_load_ps(a + (by+7)*N + bx);
+
+			__m256 lower0 = _mm256_load_ps(a + bx*N + by);
+			__m256 lower1 = _mm256_load_ps(a + (bx+1)*N + by);
+			__m256 lower2 = _mm256_load_ps(a + (bx+2)*N + by);
+			__m256 lower3 = _mm256_load_ps(a + (bx+3)*N + by);
+			__m256 lower4 = _mm256_load_ps(a + (bx+4)*N + by);
+			__m256 lower5 = _mm256_load_ps(a + (bx+5)*N + by);
+			__m256 lower6 = _mm256_load_ps(a + (bx+6)*N + by);
+			__m256 lower7 = _mm256_load_ps(a + (bx+7)*N + by);
+
+			transpose8_flt(&upper0, &upper1, &upper2, &upper3, &upper4, &upper5, &upper6, &upper7);
+			transpose8_flt(&lower0, &lower1, &lower2, &lower3, &lower4, &lower5, &lower6, &lower7);
+
+			_mm256_store_ps(a + by*N + bx, lower0);
+			_mm256_store_ps(a + (by+1)*N + bx, lower1);
+			_mm256_store_ps(a + (by+2)*N + bx, lower2);
+			_mm256_store_ps(a + (by+3)*N + bx, lower3);
+			_mm256_store_ps(a + (by+4)*N + bx, lower4);
+			_mm256_store_ps(a + (by+5)*N + bx, lower5);
+			_mm256_store_ps(a + (by+6)*N + bx, lower6);
+			_mm256_store_ps(a + (by+7)*N + bx, lower7);
+
+			_mm256_store_ps(a + bx*N + by, upper0);
+			_mm256_store_ps(a + (bx+1)*N + by, upper1);
+			_mm256_store_ps(a + (bx+2)*N + by, upper2);
+			_mm256_store_ps(a + (bx+3)*N + by, upper3);
+			_mm256_store_ps(a + (bx+4)*N + by, upper4);
+			_mm256_store_ps(a + (bx+5)*N + by, upper5);
+			_mm256_store_ps(a + (bx+6)*N + by, upper6);
+			_mm256_store_ps(a + (bx+7)*N + by, upper7);
+		}
+	}
+}
+
+void flt_forward(const float* const a, const float* const b, const float* const p, const int* const y, float* const alpha, float* const ct, const int N, const int T){
+
+	int y0 = y[0];
+	__m256 ct0_vec = _mm256_setzero_ps();
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s+=8){
+		__m256 stateProb_vec = _mm256_load_ps(p + s);
+		__m256 emission_vec = _mm256_load_ps(b + y0*N + s);
+		__m256 alphas_vec = _mm256_mul_ps(stateProb_vec, emission_vec);
+		ct0_vec = _mm256_add_ps(alphas_vec, ct0_vec);
+		_mm256_store_ps(alpha + s, alphas_vec);
+	}
+
+	ct[0] = 1.0f / reduce_flt(ct0_vec);
+	__m256 ct0_vec_div = _mm256_set1_ps(ct[0]);
+
+	for(int s = 0; s < N; s+=8){
+		__m256 alphas = _mm256_load_ps(alpha + s);
+		_mm256_store_ps(alpha + s, _mm256_mul_ps(alphas, ct0_vec_div));
+	}
+
+	//compute alpha(t)
+	for(int t = 1; t < T; t++){
+		__m256 ctt_vec = _mm256_setzero_ps();
+		const int yt = y[t];
+
+		for(int s = 0; s < N; s+=8){
+
+			__m256 alphatNs0 = _mm256_setzero_ps();
+			__m256 alphatNs1 = _mm256_setzero_ps();
+			__m256 alphatNs2 = _mm256_setzero_ps();
+			__m256 alphatNs3 = _mm256_setzero_ps();
+			__m256 alphatNs4 = _mm256_setzero_ps();
+			__m256 alphatNs5 = _mm256_setzero_ps();
+			__m256 alphatNs6 = _mm256_setzero_ps();
+			__m256 alphatNs7 = _mm256_setzero_ps();
+
+			for(int j = 0; j < N; j+=8){
+				__m256 alphaFactor = _mm256_load_ps(alpha + (size_t)(t-1)*N + j);
+
+				alphatNs0 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + s*N + j), alphatNs0);
+				alphatNs1 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+1)*N + j), alphatNs1);
+				alphatNs2 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+2)*N + j), alphatNs2);
+				alphatNs3 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+3)*N + j), alphatNs3);
+				alphatNs4 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+4)*N + j), alphatNs4);
+				alphatNs5 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+5)*N + j), alphatNs5);
+				alphatNs6 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+6)*N + j), alphatNs6);
+				alphatNs7 = _mm256_fmadd_ps(alphaFactor, _mm256_load_ps(a + (s+7)*N + j), alphatNs7);
+			}
+
+			__m256 alpha_tot = reduce8_flt(alphatNs0, alphatNs1, alphatNs2, alphatNs3, alphatNs4, alphatNs5, alphatNs6, alphatNs7);
+			__m256 alpha_tot_mul = _mm256_mul_ps(alpha_tot, _mm256_load_ps(b + yt*N + s));
+
+			ctt_vec = _mm256_add_ps(alpha_tot_mul, ctt_vec);
+
+			_mm256_store_ps(alpha + (size_t)t*N + s, alpha_tot_mul);
+		}
+
+		ct[t] = 1.0f / reduce_flt(ctt_vec);
+		__m256 ctt_vec_div = _mm256_set1_ps(ct[t]);
+
+		for(int s = 0; s < N; s+=8){
+			__m256 alphas = _mm256_load_ps(alpha + (size_t)t*N + s);
+			_mm256_store_ps(alpha + (size_t)t*N + s, _mm256_mul_ps(alphas, ctt_vec_div));
+		}
+	}
+}
+
+void flt_build_ab(const float* const a, const float* const b, float* const ab, const int N, const int K){
+
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s++){
+			for(int j = 0; j < N; j+=8){
+				__m256 transition = _mm256_load_ps(a + s*N + j);
+				__m256 emission = _mm256_load_ps(b + v*N + j);
+
+				_mm256_store_ps(ab + ((size_t)v*N + s)*N + j, _mm256_mul_ps(transition, emission));
+			}
+		}
+	}
+}
+
+void flt_backward(const float* const ab, const float* const alpha, const float* const ct, const int* const y, float* const beta, float* const beta_new, float* const gamma0, float* const p_new, float* const gamma_sum, float* const gamma_T, float* const a_new, float* const b_new, const int N, const int T){
+
+	float* beta_cur = beta;
+	float* beta_nxt = beta_new;
+	__m256 ctT_vec = _mm256_set1_ps(ct[T-1]);
+	int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s+=8){
+		__m256 alphaT1Ns = _mm256_load_ps(alpha + (size_t)(T-1)*N + s);
+		__m256 gamma_Ts = _mm256_load_ps(gamma_T + s);
+		__m256 b_new_vec = _mm256_load_ps(b_new + yt*N + s);
+
+		_mm256_store_ps(beta_cur + s, ctT_vec);
+		_mm256_store_ps(gamma0 + s, alphaT1Ns);
+		_mm256_store_ps(gamma_T + s, _mm256_add_ps(gamma_Ts, alphaT1Ns));
+		_mm256_store_ps(b_new + yt*N + s, _mm256_add_ps(b_new_vec, alphaT1Ns));
+	}
+
+	for(int t = T-1; t > 0; t--){
+		__m128 ctt_vec = _mm_set1_ps(ct[t-1]);
+		const int yt1 = y[t-1];
+
+		//four states at a time, the sums over j run over eight lanes
+		for(int s = 0; s < N; s+=4){
+			__m256 alphat1Ns0_vec = _mm256_set1_ps(alpha[(size_t)(t-1)*N + s]);
+			__m256 alphat1Ns1_vec = _mm256_set1_ps(alpha[(size_t)(t-1)*N + s+1]);
+			__m256 alphat1Ns2_vec = _mm256_set1_ps(alpha[(size_t)(t-1)*N + s+2]);
+			__m256 alphat1Ns3_vec = _mm256_set1_ps(alpha[(size_t)(t-1)*N + s+3]);
+
+			__m256 beta_news0 = _mm256_setzero_ps();
+			__m256 beta_news1 = _mm256_setzero_ps();
+			__m256 beta_news2 = _mm256_setzero_ps();
+			__m256 beta_news3 = _mm256_setzero_ps();
+
+			for(int j = 0; j < N; j+=8){
+				__m256 beta_vec = _mm256_load_ps(beta_cur + j);
+
+				__m256 temp0 = _mm256_mul_ps(_mm256_load_ps(ab + ((size_t)yt*N + s)*N + j), beta_vec);
+				__m256 temp1 = _mm256_mul_ps(_mm256_load_ps(ab + ((size_t)yt*N + s+1)*N + j), beta_vec);
+				__m256 temp2 = _mm256_mul_ps(_mm256_load_ps(ab + ((size_t)yt*N + s+2)*N + j), beta_vec);
+				__m256 temp3 = _mm256_mul_ps(_mm256_load_ps(ab + ((size_t)yt*N + s+3)*N + j), beta_vec);
+
+				__m256 a_new_vec0 = _mm256_load_ps(a_new + s*N + j);
+				__m256 a_new_vec1 = _mm256_load_ps(a_new + (s+1)*N + j);
+				__m256 a_new_vec2 = _mm256_load_ps(a_new + (s+2)*N + j);
+				__m256 a_new_vec3 = _mm256_load_ps(a_new + (s+3)*N + j);
+
+				_mm256_store_ps(a_new + s*N + j, _mm256_fmadd_ps(alphat1Ns0_vec, temp0, a_new_vec0));
+				_mm256_store_ps(a_new + (s+1)*N + j, _mm256_fmadd_ps(alphat1Ns1_vec, temp1, a_new_vec1));
+				_mm256_store_ps(a_new + (s+2)*N + j, _mm256_fmadd_ps(alphat1Ns2_vec, temp2, a_new_vec2));
+				_mm256_store_ps(a_new + (s+3)*N + j, _mm256_fmadd_ps(alphat1Ns3_vec, temp3, a_new_vec3));
+
+				beta_news0 = _mm256_add_ps(beta_news0, temp0);
+				beta_news1 = _mm256_add_ps(beta_news1, temp1);
+				beta_news2 = _mm256_add_ps(beta_news2, temp2);
+				beta_news3 = _mm256_add_ps(beta_news3, temp3);
+			}
+
+			__m128 beta_news = reduce4_flt(beta_news0, beta_news1, beta_news2, beta_news3);
+			__m128 ps = _mm_mul_ps(_mm_load_ps(alpha + (size_t)(t-1)*N + s), beta_news);
+
+			_mm_store_ps(gamma0 + s, ps);
+			_mm_store_ps(beta_nxt + s, _mm_mul_ps(beta_news, ctt_vec));
+			_mm_store_ps(gamma_sum + s, _mm_add_ps(_mm_load_ps(gamma_sum + s), ps));
+			_mm_store_ps(b_new + yt1*N + s, _mm_add_ps(_mm_load_ps(b_new + yt1*N + s), ps));
+		}
+
+		float* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	flt_add(p_new, gamma0, 1, N);
+}
+
+void flt_update(float* const a, float* const b, float* const p, float* const gamma_sum, float* const gamma_T, const float* const p_new, const float* const a_new, const float* const b_new, const int sequences, const int N, const int K){
+
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 sequences_inv = _mm256_set1_ps(1.0f / sequences);
+
+	//add remaining parts of the sum of gamma
+	for(int s = 0; s < N; s+=8){
+		__m256 gamma_Ts = _mm256_load_ps(gamma_T + s);
+		__m256 gamma_sums = _mm256_load_ps(gamma_sum + s);
+
+		_mm256_store_ps(gamma_T + s, _mm256_div_ps(one, _mm256_add_ps(gamma_Ts, gamma_sums)));
+		_mm256_store_ps(gamma_sum + s, _mm256_div_ps(one, gamma_sums));
+		_mm256_store_ps(p + s, _mm256_mul_ps(_mm256_load_ps(p_new + s), sequences_inv));
+	}
+
+	//compute new transition matrix
+	for(int s = 0; s < N; s++){
+		__m256 gamma_inv = _mm256_set1_ps(gamma_sum[s]);
+
+		for(int j = 0; j < N; j+=8){
+			_mm256_store_ps(a + s*N + j, _mm256_mul_ps(_mm256_load_ps(a_new + s*N + j), gamma_inv));
+		}
+	}
+
+	//compute new emission matrix
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s+=8){
+			_mm256_store_ps(b + v*N + s, _mm256_mul_ps(_mm256_load_ps(b_new + v*N + s), _mm256_load_ps(gamma_T + s)));
+		}
+	}
+}
+
+void flt_zero(float* const a, const int N, const int M){
+
+	__m256 zero = _mm256_setzero_ps();
+
+	for(int i = 0; i < N*M; i+=8){
+		_mm256_store_ps(a + i, zero);
+	}
+}
+
+void flt_add(float* const a, const float* const b, const int N, const int M){
+
+	for(int i = 0; i < N*M; i+=8){
+		_mm256_store_ps(a + i, _mm256_add_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+	}
+}
+
+//same product of mantissas as sca_log_likelihood, in double
+double flt_log_likelihood(const float* const ct, const int T){
+
+	double mantissa = 1.0;
+	long exponent = 0;
+
+	for(int t = 0; t < T; t++){
+		int e;
+		mantissa = frexp(mantissa * ct[t], &e);
+		exponent += e;
+	}
+
+	return -(exponent + log2(mantissa));
+}
@@ -0,0 +1,290 @@
+#include <math.h>
+#include <float.h>
+#include <immintrin.h>
+
+#include "bw-kernels.h"
+
+//Log domain kernels on AVX2 (built with AVX2FLAGS, the exponent tricks need the 256 bit integer instructions).
+//Every log-sum-exp is done in two passes over the row: the maximum, then the sum of exp(x - maximum).
+//Rows that are all -inf (states that cannot be reached) take 0 as maximum, so they stay at -inf without NaN.
+
+//exp for any x, exactly 0 below -708 (no subnormal results)
+//exp(x) = 2^k * exp(r) with |r| <= ln(2)/2, exp(r) by its Taylor series up to r^12
+static inline __m256d exp_vec(const __m256d x){
+
+	const __m256d lower = _mm256_set1_pd(-708.0);
+	const __m256d xc = _mm256_max_pd(_mm256_min_pd(x, _mm256_set1_pd(709.0)), lower);
+
+	const __m256d k = _mm256_round_pd(_mm256_mul_pd(xc, _mm256_set1_pd(1.44269504088896340736)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(6.93147180369123816490e-01), xc);
+	r = _mm256_fnmadd_pd(k, _mm256_set1_pd(1.90821492927058770002e-10), r);
+
+	__m256d poly = _mm256_set1_pd(1.0/479001600.0);
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/39916800.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/3628800.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/362880.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/40320.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/5040.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/720.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/120.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/24.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0/6.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(0.5));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0));
+	poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(1.0));
+
+	//k sits in the low bits of k + 1.5*2^52, move k + 1023 into the exponent field
+	__m256i bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(6755399441055744.0)));
+	bits = _mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52);
+
+	const __m256d result = _mm256_mul_pd(poly, _mm256_castsi256_pd(bits));
+
+	return _mm256_and_pd(result, _mm256_cmp_pd(x, lower, _CMP_GE_OQ));
+}
+
+//natural log of normal positive x, -inf for 0
+//exponent and mantissa split like the log2 approximation in experiments/logs.c,
+//the mantissa m in [sqrt(1/2), sqrt(2)) goes through 2*atanh((m-1)/(m+1)) up to the power 17 for double accuracy
+static inline __m256d log_vec(const __m256d x){
+
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256i bits = _mm256_castpd_si256(x);
+
+	//biased exponent as double: put it below the exponent of 2^52 and subtract 2^52
+	const __m256i exponent_bits = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)));
+	__m256d e = _mm256_sub_pd(_mm256_castsi256_pd(exponent_bits), _mm256_set1_pd(4503599627370496.0 + 1023.0));
+
+	__m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm256_castpd_si256(one)));
+
+	const __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+	m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+	e = _mm256_add_pd(e, _mm256_and_pd(big, one));
+
+	const __m256d f = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+	const __m256d f2 = _mm256_mul_pd(f, f);
+
+	__m256d poly = _mm256_set1_pd(1.0/17.0);
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/15.0));
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/13.0));
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/11.0));
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/9.0));
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/7.0));
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/5.0));
+	poly = _mm256_fmadd_pd(poly, f2, _mm256_set1_pd(1.0/3.0));
+	poly = _mm256_fmadd_pd(poly, f2, one);
+	poly = _mm256_mul_pd(_mm256_add_pd(f, f), poly);
+
+	__m256d result = _mm256_fmadd_pd(e, _mm256_set1_pd(1.90821492927058770002e-10), poly);
+	result = _mm256_fmadd_pd(e, _mm256_set1_pd(6.93147180369123816490e-01), result);
+
+	return _mm256_blendv_pd(result, _mm256_set1_pd(-INFINITY), _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ));
+}
+
+//lane i of the result is the maximum of the four lanes of xi
+static inline __m256d reduce4_max(const __m256d x0, const __m256d x1, const __m256d x2, const __m256d x3){
+
+	__m256d x01 = _mm256_max_pd(_mm256_unpacklo_pd(x0, x1), _mm256_unpackhi_pd(x0, x1));
+	__m256d x23 = _mm256_max_pd(_mm256_unpacklo_pd(x2, x3), _mm256_unpackhi_pd(x2, x3));
+
+	return _mm256_max_pd(_mm256_permute2f128_pd(x01, x23, 0x20), _mm256_permute2f128_pd(x01, x23, 0x31));
+}
+
+//lane i of the result is the sum of the four lanes of xi
+static inline __m256d reduce4_add(const __m256d x0, const __m256d x1, const __m256d x2, const __m256d x3){
+
+	__m256d x01 = _mm256_hadd_pd(x0, x1);
+	__m256d x23 = _mm256_hadd_pd(x2, x3);
+
+	return _mm256_add_pd(_mm256_permute2f128_pd(x01, x23, 0x20), _mm256_permute2f128_pd(x01, x23, 0x31));
+}
+
+//maxima of rows that are all -inf become 0
+static inline __m256d finite_max(const __m256d m){
+	return _mm256_blendv_pd(m, _mm256_setzero_pd(), _mm256_cmp_pd(m, _mm256_set1_pd(-INFINITY), _CMP_EQ_OQ));
+}
+
+void vec_logarithm(double* const a, const int N, const int M){
+
+	for(int i = 0; i < N*M; i+=4){
+		__m256d x = _mm256_load_pd(a + i);
+
+		//subnormals are too rare to be worth a vectorized path
+		if(_mm256_movemask_pd(_mm256_cmp_pd(x, _mm256_set1_pd(DBL_MIN), _CMP_LT_OQ))){
+			for(int k = i; k < i + 4; k++){
+				a[k] = log(a[k]);
+			}
+		}else{
+			_mm256_store_pd(a + i, log_vec(x));
+		}
+	}
+}
+
+double vec_log_forward(const double* const la, const double* const lb, const double* const lp, const int* const y, double* const lalpha, const int N, const int T){
+
+	const int y0 = y[0];
+
+	//compute log alpha(0)
+	for(int s = 0; s < N; s+=4){
+		_mm256_store_pd(lalpha + s, _mm256_add_pd(_mm256_load_pd(lp + s), _mm256_load_pd(lb + y0*N + s)));
+	}
+
+	//compute log alpha(t)
+	for(int t = 1; t < T; t++){
+		const double* const prev = lalpha + (size_t)(t-1)*N;
+		const int yt = y[t];
+
+		for(int s = 0; s < N; s+=4){
+			const double* const la0 = la + s*N;
+			const double* const la1 = la + (s+1)*N;
+			const double* const la2 = la + (s+2)*N;
+			const double* const la3 = la + (s+3)*N;
+
+			__m256d max0 = _mm256_set1_pd(-INFINITY);
+			__m256d max1 = max0;
+			__m256d max2 = max0;
+			__m256d max3 = max0;
+
+			for(int j = 0; j < N; j+=4){
+				__m256d prevj = _mm256_load_pd(prev + j);
+				max0 = _mm256_max_pd(max0, _mm256_add_pd(prevj, _mm256_load_pd(la0 + j)));
+				max1 = _mm256_max_pd(max1, _mm256_add_pd(prevj, _mm256_load_pd(la1 + j)));
+				max2 = _mm256_max_pd(max2, _mm256_add_pd(prevj, _mm256_load_pd(la2 + j)));
+				max3 = _mm256_max_pd(max3, _mm256_add_pd(prevj, _mm256_load_pd(la3 + j)));
+			}
+
+			__m256d maxs = finite_max(reduce4_max(max0, max1, max2, max3));
+			max0 = _mm256_permute4x64_pd(maxs, 0x00);
+			max1 = _mm256_permute4x64_pd(maxs, 0x55);
+			max2 = _mm256_permute4x64_pd(maxs, 0xAA);
+			max3 = _mm256_permute4x64_pd(maxs, 0xFF);
+
+			__m256d sum0 = _mm256_setzero_pd();
+			__m256d sum1 = _mm256_setzero_pd();
+			__m256d sum2 = _mm256_setzero_pd();
+			__m256d sum3 = _mm256_setzero_pd();
+
+			for(int j = 0; j < N; j+=4){
+				__m256d prevj = _mm256_load_pd(prev + j);
+				sum0 = _mm256_add_pd(sum0, exp_vec(_mm256_sub_pd(_mm256_add_pd(prevj, _mm256_load_pd(la0 + j)), max0)));
+				sum1 = _mm256_add_pd(sum1, exp_vec(_mm256_sub_pd(_mm256_add_pd(prevj, _mm256_load_pd(la1 + j)), max1)));
+				sum2 = _mm256_add_pd(sum2, exp_vec(_mm256_sub_pd(_mm256_add_pd(prevj, _mm256_load_pd(la2 + j)), max2)));
+				sum3 = _mm256_add_pd(sum3, exp_vec(_mm256_sub_pd(_mm256_add_pd(prevj, _mm256_load_pd(la3 + j)), max3)));
+			}
+
+			__m256d lse = _mm256_add_pd(maxs, log_vec(reduce4_add(sum0, sum1, sum2, sum3)));
+			_mm256_store_pd(lalpha + (size_t)t*N + s, _mm256_add_pd(lse, _mm256_load_pd(lb + yt*N + s)));
+		}
+	}
+
+	//log P(y) = log-sum-exp of log alpha(T-1)
+	const double* const last = lalpha + (size_t)(T-1)*N;
+	double max = -INFINITY;
+	double sum = 0.0;
+
+	for(int s = 0; s < N; s++){
+		max = last[s] > max ? last[s] : max;
+	}
+
+	for(int s = 0; s < N; s++){
+		sum += exp(last[s] - max);
+	}
+
+	return max + log(sum);
+}
+
+void vec_log_backward(const double* const lab, const double* const lalpha, const double lnP, const int* const y, double* const lbeta, double* const lbeta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T){
+
+	double* beta_cur = lbeta;
+	double* beta_nxt = lbeta_new;
+	__m256d lnP_vec = _mm256_set1_pd(lnP);
+	int yt = y[T-1];
+
+	//log beta(T-1) = 0, gamma(T-1) = alpha(T-1) / P(y)
+	for(int s = 0; s < N; s+=4){
+		__m256d gammas = exp_vec(_mm256_sub_pd(_mm256_load_pd(lalpha + (size_t)(T-1)*N + s), lnP_vec));
+
+		_mm256_store_pd(beta_cur + s, _mm256_setzero_pd());
+		_mm256_store_pd(gamma0 + s, gammas);
+		_mm256_store_pd(gamma_T + s, _mm256_add_pd(_mm256_load_pd(gamma_T + s), gammas));
+		_mm256_store_pd(b_new + yt*N + s, _mm256_add_pd(_mm256_load_pd(b_new + yt*N + s), gammas));
+	}
+
+	for(int t = T-1; t > 0; t--){
+		const int yt1 = y[t-1];
+
+		for(int s = 0; s < N; s+=4){
+			const double* const lab0 = lab + (yt*N + s)*N;
+			const double* const lab1 = lab + (yt*N + s+1)*N;
+			const double* const lab2 = lab + (yt*N + s+2)*N;
+			const double* const lab3 = lab + (yt*N + s+3)*N;
+
+			__m256d max0 = _mm256_set1_pd(-INFINITY);
+			__m256d max1 = max0;
+			__m256d max2 = max0;
+			__m256d max3 = max0;
+
+			for(int j = 0; j < N; j+=4){
+				__m256d betaj = _mm256_load_pd(beta_cur + j);
+				max0 = _mm256_max_pd(max0, _mm256_add_pd(betaj, _mm256_load_pd(lab0 + j)));
+				max1 = _mm256_max_pd(max1, _mm256_add_pd(betaj, _mm256_load_pd(lab1 + j)));
+				max2 = _mm256_max_pd(max2, _mm256_add_pd(betaj, _mm256_load_pd(lab2 + j)));
+				max3 = _mm256_max_pd(max3, _mm256_add_pd(betaj, _mm256_load_pd(lab3 + j)));
+			}
+
+			__m256d maxs = finite_max(reduce4_max(max0, max1, max2, max3));
+
+			//xi(t-1)(s,j) = scale(s) * exp(lab(s,j) + log beta(t)(j) - max(s))
+			__m256d scale = exp_vec(_mm256_sub_pd(_mm256_add_pd(_mm256_load_pd(lalpha + (size_t)(t-1)*N + s), maxs), lnP_vec));
+			__m256d scale0 = _mm256_permute4x64_pd(scale, 0x00);
+			__m256d scale1 = _mm256_permute4x64_pd(scale, 0x55);
+			__m256d scale2 = _mm256_permute4x64_pd(scale, 0xAA);
+			__m256d scale3 = _mm256_permute4x64_pd(scale, 0xFF);
+
+			max0 = _mm256_permute4x64_pd(maxs, 0x00);
+			max1 = _mm256_permute4x64_pd(maxs, 0x55);
+			max2 = _mm256_permute4x64_pd(maxs, 0xAA);
+			max3 = _mm256_permute4x64_pd(maxs, 0xFF);
+
+			__m256d sum0 = _mm256_setzero_pd();
+			__m256d sum1 = _mm256_setzero_pd();
+			__m256d sum2 = _mm256_setzero_pd();
+			__m256d sum3 = _mm256_setzero_pd();
+
+			for(int j = 0; j < N; j+=4){
+				__m256d betaj = _mm256_load_pd(beta_cur + j);
+
+				__m256d e0 = exp_vec(_mm256_sub_pd(_mm256_add_pd(betaj, _mm256_load_pd(lab0 + j)), max0));
+				__m256d e1 = exp_vec(_mm256_sub_pd(_mm256_add_pd(betaj, _mm256_load_pd(lab1 + j)), max1));
+				__m256d e2 = exp_vec(_mm256_sub_pd(_mm256_add_pd(betaj, _mm256_load_pd(lab2 + j)), max2));
+				__m256d e3 = exp_vec(_mm256_sub_pd(_mm256_add_pd(betaj, _mm256_load_pd(lab3 + j)), max3));
+
+				_mm256_store_pd(a_new + s*N + j, _mm256_fmadd_pd(scale0, e0, _mm256_load_pd(a_new + s*N + j)));
+				_mm256_store_pd(a_new + (s+1)*N + j, _mm256_fmadd_pd(scale1, e1, _mm256_load_pd(a_new + (s+1)*N + j)));
+				_mm256_store_pd(a_new + (s+2)*N + j, _mm256_fmadd_pd(scale2, e2, _mm256_load_pd(a_new + (s+2)*N + j)));
+				_mm256_store_pd(a_new + (s+3)*N + j, _mm256_fmadd_pd(scale3, e3, _mm256_load_pd(a_new + (s+3)*N + j)));
+
+				sum0 = _mm256_add_pd(sum0, e0);
+				sum1 = _mm256_add_pd(sum1, e1);
+				sum2 = _mm256_add_pd(sum2, e2);
+				sum3 = _mm256_add_pd(sum3, e3);
+			}
+
+			__m256d sums = reduce4_add(sum0, sum1, sum2, sum3);
+
+			//gamma(t-1)(s) = alpha(t-1)(s) * beta(t-1)(s) / P(y)
+			__m256d ps = _mm256_mul_pd(scale, sums);
+
+			_mm256_store_pd(beta_nxt + s, _mm256_add_pd(maxs, log_vec(sums)));
+			_mm256_store_pd(gamma0 + s, ps);
+			_mm256_store_pd(gamma_sum + s, _mm256_add_pd(_mm256_load_pd(gamma_sum + s), ps));
+			_mm256_store_pd(b_new + yt1*N + s, _mm256_add_pd(_mm256_load_pd(b_new + yt1*N + s), ps));
+		}
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	vec_add(p_new, gamma0, 1, N);
+}
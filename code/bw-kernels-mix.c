@@ -0,0 +1,191 @@
+#include <math.h>
+#include <immintrin.h>
+
+#include "bw-kernels.h"
+
+//horizontal sum of the four lanes, broadcasted into all lanes
+static inline __m256d reduce_vec(const __m256d x){
+
+	__m256d perm = _mm256_permute2f128_pd(x,x,0b00000011);
+
+	__m256d shuffle1 = _mm256_shuffle_pd(x, perm, 0b0101);
+	__m256d shuffle2 = _mm256_shuffle_pd(perm, x, 0b0101);
+
+	__m256d x_add = _mm256_add_pd(x, perm);
+	__m256d x_temp = _mm256_add_pd(shuffle1, shuffle2);
+
+	return _mm256_add_pd(x_add, x_temp);
+}
+
+//four floats of alpha widened to double
+static inline __m256d load_alpha(const float* const alpha){
+	return _mm256_cvtps_pd(_mm_load_ps(alpha));
+}
+
+void mix_forward(const double* const a, const double* const b, const double* const p, const int* const y, float* const alpha, double* const ct, double* const scratch, const int N, const int T){
+
+	__m256d one = _mm256_set1_pd(1.0);
+	int y0 = y[0];
+	__m256d ct0_vec = _mm256_setzero_pd();
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s+=4){
+		__m256d stateProb_vec = _mm256_load_pd(p +s);
+		__m256d emission_vec = _mm256_load_pd(b +y0*N +s);
+		__m256d alphas_vec = _mm256_mul_pd(stateProb_vec, emission_vec);
+		ct0_vec = _mm256_fmadd_pd(stateProb_vec,emission_vec, ct0_vec);
+		_mm256_store_pd(scratch+s,alphas_vec);
+	}
+
+	__m256d ct0_vec_div = _mm256_div_pd(one, reduce_vec(ct0_vec));
+	ct[0] = _mm256_cvtsd_f64(ct0_vec_div);
+
+	for(int s = 0; s < N; s+=4){
+		__m256d alphas=_mm256_load_pd(scratch+s);
+		_mm_store_ps(alpha+s,_mm256_cvtpd_ps(_mm256_mul_pd(alphas,ct0_vec_div)));
+	}
+
+	//compute alpha(t), unscaled in scratch and scaled in alpha
+	for(int t = 1; t < T; t++){
+		__m256d ctt_vec = _mm256_setzero_pd();
+		const int yt = y[t];
+
+		for(int s = 0; s<N; s+=4){
+
+			__m256d alphatNs0 = _mm256_setzero_pd();
+			__m256d alphatNs1 = _mm256_setzero_pd();
+			__m256d alphatNs2 = _mm256_setzero_pd();
+			__m256d alphatNs3 = _mm256_setzero_pd();
+
+			for(int j = 0; j < N; j+=4){
+				__m256d alphaFactor=load_alpha(alpha+(size_t)(t-1)*N+j);
+
+				__m256d transition0=_mm256_load_pd(a+(s)*N+j);
+				__m256d transition1=_mm256_load_pd(a+(s+1)*N+j);
+				__m256d transition2=_mm256_load_pd(a+(s+2)*N+j);
+				__m256d transition3=_mm256_load_pd(a+(s+3)*N+j);
+
+				alphatNs0 =_mm256_fmadd_pd(alphaFactor,transition0,alphatNs0);
+				alphatNs1 =_mm256_fmadd_pd(alphaFactor,transition1,alphatNs1);
+				alphatNs2 =_mm256_fmadd_pd(alphaFactor,transition2,alphatNs2);
+				alphatNs3 =_mm256_fmadd_pd(alphaFactor,transition3,alphatNs3);
+			}
+
+			__m256d emission = _mm256_load_pd(b + yt*N + s);
+
+			__m256d alpha01 = _mm256_hadd_pd(alphatNs0, alphatNs1);
+			__m256d alpha23 = _mm256_hadd_pd(alphatNs2, alphatNs3);
+
+			__m256d permute01 = _mm256_permute2f128_pd(alpha01, alpha23, 0b00110000);
+			__m256d permute23 = _mm256_permute2f128_pd(alpha01, alpha23, 0b00100001);
+
+			__m256d alpha_tot = _mm256_add_pd(permute01, permute23);
+			__m256d alpha_tot_mul = _mm256_mul_pd(alpha_tot,emission);
+
+			ctt_vec = _mm256_add_pd(alpha_tot_mul,ctt_vec);
+
+			_mm256_store_pd(scratch + s,alpha_tot_mul);
+		}
+
+		__m256d ctt_vec_div = _mm256_div_pd(one, reduce_vec(ctt_vec));
+		ct[t] = _mm256_cvtsd_f64(ctt_vec_div);
+
+		for(int s = 0; s<N; s+=4){
+			__m256d alphas=_mm256_load_pd(scratch+s);
+			_mm_store_ps(alpha+(size_t)t*N+s,_mm256_cvtpd_ps(_mm256_mul_pd(alphas,ctt_vec_div)));
+		}
+	}
+}
+
+void mix_backward(const double* const ab, const float* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	__m256d ctT_vec = _mm256_set1_pd(ct[T-1]);
+	int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s+=4){
+		__m256d alphaT1Ns = load_alpha(alpha + (size_t)(T-1)*N + s);
+		__m256d gamma_Ts = _mm256_load_pd(gamma_T + s);
+		__m256d b_new_vec = _mm256_load_pd(b_new + yt*N + s);
+
+		_mm256_store_pd(beta_cur + s, ctT_vec);
+		_mm256_store_pd(gamma0 + s, alphaT1Ns);
+		_mm256_store_pd(gamma_T + s, _mm256_add_pd(gamma_Ts, alphaT1Ns));
+		_mm256_store_pd(b_new + yt*N + s, _mm256_add_pd(b_new_vec, alphaT1Ns));
+	}
+
+	for(int t = T-1; t > 0; t--){
+		__m256d ctt_vec = _mm256_set1_pd(ct[t-1]);
+		const int yt1 = y[t-1];
+
+		for(int s = 0; s < N ; s+=4){
+			__m256d alphatNs = load_alpha(alpha + (size_t)(t-1)*N + s);
+
+			__m256d alphat1Ns0_vec = _mm256_set1_pd(alpha[(size_t)(t-1)*N + s]);
+			__m256d alphat1Ns1_vec = _mm256_set1_pd(alpha[(size_t)(t-1)*N + s+1]);
+			__m256d alphat1Ns2_vec = _mm256_set1_pd(alpha[(size_t)(t-1)*N + s+2]);
+			__m256d alphat1Ns3_vec = _mm256_set1_pd(alpha[(size_t)(t-1)*N + s+3]);
+
+			__m256d beta_news0 = _mm256_setzero_pd();
+			__m256d beta_news1 = _mm256_setzero_pd();
+			__m256d beta_news2 = _mm256_setzero_pd();
+			__m256d beta_news3 = _mm256_setzero_pd();
+
+			for(int j = 0; j < N; j+=4){
+				__m256d beta_vec = _mm256_load_pd(beta_cur+j);
+
+				__m256d abs0 = _mm256_load_pd(ab + (yt*N + s)*N + j);
+				__m256d abs1 = _mm256_load_pd(ab + (yt*N + s+1)*N + j);
+				__m256d abs2 = _mm256_load_pd(ab + (yt*N + s+2)*N + j);
+				__m256d abs3 = _mm256_load_pd(ab + (yt*N + s+3)*N + j);
+
+				__m256d temp = _mm256_mul_pd(abs0,beta_vec);
+				__m256d temp1 = _mm256_mul_pd(abs1,beta_vec);
+				__m256d temp2 = _mm256_mul_pd(abs2,beta_vec);
+				__m256d temp3 = _mm256_mul_pd(abs3,beta_vec);
+
+				__m256d a_new_vec = _mm256_load_pd(a_new + s*N+j);
+				__m256d a_new_vec1 = _mm256_load_pd(a_new + (s+1)*N+j);
+				__m256d a_new_vec2 = _mm256_load_pd(a_new + (s+2)*N+j);
+				__m256d a_new_vec3 = _mm256_load_pd(a_new + (s+3)*N+j);
+
+				_mm256_store_pd(a_new + s*N+j,_mm256_fmadd_pd(alphat1Ns0_vec, temp,a_new_vec));
+				_mm256_store_pd(a_new + (s+1)*N+j,_mm256_fmadd_pd(alphat1Ns1_vec, temp1,a_new_vec1));
+				_mm256_store_pd(a_new + (s+2)*N+j,_mm256_fmadd_pd(alphat1Ns2_vec, temp2,a_new_vec2));
+				_mm256_store_pd(a_new + (s+3)*N+j,_mm256_fmadd_pd(alphat1Ns3_vec, temp3,a_new_vec3));
+
+				beta_news0 = _mm256_add_pd(beta_news0,temp);
+				beta_news1 = _mm256_add_pd(beta_news1,temp1);
+				beta_news2 = _mm256_add_pd(beta_news2,temp2);
+				beta_news3 = _mm256_add_pd(beta_news3,temp3);
+			}
+
+			__m256d gamma_sum_vec = _mm256_load_pd(gamma_sum + s);
+			__m256d b_new_vec = _mm256_load_pd(b_new +yt1*N+ s);
+
+			__m256d beta01 = _mm256_hadd_pd(beta_news0, beta_news1);
+			__m256d beta23 = _mm256_hadd_pd(beta_news2, beta_news3);
+
+			__m256d permute01 = _mm256_permute2f128_pd(beta01, beta23, 0b00110000);
+			__m256d permute23 = _mm256_permute2f128_pd(beta01, beta23, 0b00100001);
+
+			__m256d beta_news = _mm256_add_pd(permute01, permute23);
+
+			__m256d ps = _mm256_mul_pd(alphatNs, beta_news);
+
+			_mm256_store_pd(gamma0 + s, ps);
+			_mm256_store_pd(beta_nxt + s, _mm256_mul_pd(beta_news, ctt_vec));
+			_mm256_store_pd(gamma_sum+s, _mm256_add_pd(gamma_sum_vec, ps));
+			_mm256_store_pd(b_new +yt1*N+ s, _mm256_add_pd(b_new_vec, ps));
+		}
+
+		double * temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt=yt1;
+	}
+
+	vec_add(p_new, gamma0, 1, N);
+}
@@ -0,0 +1,510 @@
+#include <math.h>
+#include <string.h>
+
+#include "bw-kernels.h"
+
+//Scalar kernels, compiled without VECFLAGS so they run on every x86-64 host.
+//Same layouts and contracts as the ones in bw-kernels-vec.c.
+
+void sca_transpose(double* const a, const int N){
+
+	for(int row = 0 ; row < N; row++){
+		for(int col = row+1; col < N; col++){
+			double temp = a[col*N + row];
+			a[col*N + row] = a[row*N + col];
+			a[row*N + col] = temp;
+		}
+	}
+}
+
+void sca_forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T){
+
+	const int y0 = y[0];
+	double ct0 = 0.0;
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s++){
+		alpha[s] = p[s] * b[y0*N + s];
+		ct0 += alpha[s];
+	}
+
+	ct0 = 1.0 / ct0;
+	ct[0] = ct0;
+
+	for(int s = 0; s < N; s++){
+		alpha[s] *= ct0;
+	}
+
+	sca_forward_steps(a, b, y, alpha, alpha + N, ct, N, 1, T);
+}
+
+void sca_forward_steps(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last){
+
+	const double* alpha_prev = start;
+
+	//compute alpha(t)
+	for(int t = first; t < last; t++){
+		double* const alpha_cur = alpha + (size_t)(t-first)*N;
+		const int yt = y[t];
+		double ctt = 0.0;
+
+		for(int s = 0; s < N; s++){
+			double alphatNs = 0.0;
+
+			for(int j = 0; j < N; j++){
+				alphatNs += alpha_prev[j] * a[s*N + j];
+			}
+
+			alphatNs *= b[yt*N + s];
+			alpha_cur[s] = alphatNs;
+			ctt += alphatNs;
+		}
+
+		ctt = 1.0 / ctt;
+		ct[t] = ctt;
+
+		for(int s = 0; s < N; s++){
+			alpha_cur[s] *= ctt;
+		}
+
+		alpha_prev = alpha_cur;
+	}
+}
+
+//scale the N*M doubles of a to sum 1
+static void normalize(double* const a, const int N, const int M){
+
+	double sum = 0.0;
+
+	for(int i = 0; i < N*M; i++){
+		sum += a[i];
+	}
+
+	sum = 1.0 / sum;
+
+	for(int i = 0; i < N*M; i++){
+		a[i] *= sum;
+	}
+}
+
+void sca_chunk_product(const double* const ab, const int* const y, double* const product, double* const scratch, const int N, const int first, const int last){
+
+	double* cur = product;
+	double* nxt = scratch;
+
+	memcpy(cur, ab + y[first]*N*N, N * N * sizeof(double));
+	normalize(cur, N, N);
+
+	for(int t = first + 1; t < last; t++){
+		const double* const abt = ab + y[t]*N*N;
+
+		for(int s = 0; s < N; s++){
+			for(int j = 0; j < N; j++){
+				nxt[s*N + j] = 0.0;
+			}
+
+			for(int k = 0; k < N; k++){
+				const double cursk = cur[s*N + k];
+
+				for(int j = 0; j < N; j++){
+					nxt[s*N + j] += cursk * abt[k*N + j];
+				}
+			}
+		}
+
+		normalize(nxt, N, N);
+
+		double* tmp = cur;
+		cur = nxt;
+		nxt = tmp;
+	}
+
+	if(cur != product){
+		memcpy(product, cur, N * N * sizeof(double));
+	}
+}
+
+void sca_stitch(const double* const start, const double* const product, double* const next, const int N){
+
+	for(int j = 0; j < N; j++){
+		next[j] = 0.0;
+	}
+
+	for(int k = 0; k < N; k++){
+		for(int j = 0; j < N; j++){
+			next[j] += start[k] * product[k*N + j];
+		}
+	}
+
+	normalize(next, 1, N);
+}
+
+void sca_build_ab(const double* const a, const double* const b, double* const ab, const int N, const int K){
+
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s++){
+			for(int j = 0; j < N; j++){
+				ab[(v*N + s)*N + j] = a[s*N + j] * b[v*N + j];
+			}
+		}
+	}
+}
+
+void sca_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T){
+
+	sca_backward_init(alpha + (size_t)(T-1)*N, ct, y, beta, gamma0, gamma_T, b_new, N, T);
+	sca_backward_steps(ab, alpha, ct, y, beta, beta_new, gamma0, gamma_sum, a_new, b_new, N, 0, T-1);
+	sca_add(p_new, gamma0, 1, N);
+}
+
+void sca_backward_init(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T){
+
+	const double ctT = ct[T-1];
+	const int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s++){
+		beta[s] = ctT;
+		gamma0[s] = alphaT1[s];
+		gamma_T[s] += alphaT1[s];
+		b_new[yt*N + s] += alphaT1[s];
+	}
+}
+
+//one step of sca_backward_steps, abt is the N x N block of a*b of the current observation
+static void backward_step(const double* const abt, const double* const alphat1, const double ctt, const int yt1, const double* const beta_cur, double* const beta_nxt, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N){
+
+	for(int s = 0; s < N; s++){
+		const double alphat1Ns = alphat1[s];
+		double beta_news = 0.0;
+
+		for(int j = 0; j < N; j++){
+			double temp = abt[s*N + j] * beta_cur[j];
+			a_new[s*N + j] += alphat1Ns * temp;
+			beta_news += temp;
+		}
+
+		double ps = alphat1Ns * beta_news;
+
+		gamma0[s] = ps;
+		beta_nxt[s] = beta_news * ctt;
+		gamma_sum[s] += ps;
+		b_new[yt1*N + s] += ps;
+	}
+}
+
+void sca_backward_steps(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	int yt = y[last];
+
+	for(int t = last; t > first; t--){
+		const int yt1 = y[t-1];
+
+		backward_step(ab + yt*N*N, alpha + (size_t)(t-1-first)*N, ct[t-1], yt1, beta_cur, beta_nxt, gamma0, gamma_sum, a_new, b_new, N);
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	//leave beta(first) in beta
+	if(beta_cur != beta){
+		memcpy(beta, beta_cur, N * sizeof(double));
+	}
+}
+
+void sca_backward_steps_otf(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	int yt = y[last];
+
+	for(int t = last; t > first; t--){
+		const int yt1 = y[t-1];
+
+		//fold b(yt) into beta instead of into a
+		for(int j = 0; j < N; j++){
+			beta_cur[j] *= b[yt*N + j];
+		}
+
+		backward_step(a, alpha + (size_t)(t-1-first)*N, ct[t-1], yt1, beta_cur, beta_nxt, gamma0, gamma_sum, a_new, b_new, N);
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	//leave beta(first) in beta
+	if(beta_cur != beta){
+		memcpy(beta, beta_cur, N * sizeof(double));
+	}
+}
+
+void sca_backward_blocked(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, double* const w, const int N, const int T, const int B){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+
+	sca_backward_init(alpha + (size_t)(T-1)*N, ct, y, beta, gamma0, gamma_T, b_new, N, T);
+
+	for(int hi = T-1; hi > 0; hi -= B){
+		const int lo = hi - B + 1 > 1 ? hi - B + 1 : 1;
+
+		for(int t = hi; t >= lo; t--){
+			double* const wt = w + (t-lo)*N;
+			const double* const alphat1 = alpha + (size_t)(t-1)*N;
+			const double ctt = ct[t-1];
+			const int yt = y[t];
+			const int yt1 = y[t-1];
+
+			for(int j = 0; j < N; j++){
+				wt[j] = b[yt*N + j] * beta_cur[j];
+			}
+
+			for(int s = 0; s < N; s++){
+				double beta_news = 0.0;
+
+				for(int j = 0; j < N; j++){
+					beta_news += a[s*N + j] * wt[j];
+				}
+
+				double ps = alphat1[s] * beta_news;
+
+				gamma0[s] = ps;
+				beta_nxt[s] = beta_news * ctt;
+				gamma_sum[s] += ps;
+				b_new[yt1*N + s] += ps;
+			}
+
+			double* temp = beta_nxt;
+			beta_nxt = beta_cur;
+			beta_cur = temp;
+		}
+
+		//a_new += alpha(lo-1...hi-1)^T * w
+		for(int i = 0; i <= hi - lo; i++){
+			for(int s = 0; s < N; s++){
+				const double alphas = alpha[(size_t)(lo-1+i)*N + s];
+
+				for(int j = 0; j < N; j++){
+					a_new[s*N + j] += alphas * w[i*N + j];
+				}
+			}
+		}
+	}
+
+	sca_add(p_new, gamma0, 1, N);
+}
+
+void sca_update(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K){
+
+	//add remaining parts of the sum of gamma
+	for(int s = 0; s < N; s++){
+		gamma_T[s] = 1.0 / (gamma_T[s] + gamma_sum[s]);
+		gamma_sum[s] = 1.0 / gamma_sum[s];
+		p[s] = p_new[s] / sequences;
+	}
+
+	//compute new transition matrix
+	for(int s = 0; s < N; s++){
+		for(int j = 0; j < N; j++){
+			a[s*N + j] = a_new[s*N + j] * gamma_sum[s];
+		}
+	}
+
+	//compute new emission matrix
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s++){
+			b[v*N + s] = b_new[v*N + s] * gamma_T[s];
+		}
+	}
+}
+
+void sca_zero(double* const a, const int N, const int M){
+
+	for(int i = 0; i < N*M; i++){
+		a[i] = 0.0;
+	}
+}
+
+void sca_add(double* const a, const double* const b, const int N, const int M){
+
+	for(int i = 0; i < N*M; i++){
+		a[i] += b[i];
+	}
+}
+
+//-sum log2(ct(t)) with one log2: the product of the ct is kept as a mantissa in [0.5,1) and a sum of exponents
+double sca_log_likelihood(const double* const ct, const int T){
+
+	double mantissa = 1.0;
+	long exponent = 0;
+
+	for(int t = 0; t < T; t++){
+		int e;
+		mantissa = frexp(mantissa * ct[t], &e);
+		exponent += e;
+	}
+
+	return -(exponent + log2(mantissa));
+}
+
+void sca_logarithm(double* const a, const int N, const int M){
+
+	for(int i = 0; i < N*M; i++){
+		a[i] = log(a[i]);
+	}
+}
+
+//maximum of x[j] + y[j], 0 if all of them are -inf
+static double finite_max(const double* const x, const double* const y, const int N){
+
+	double max = -INFINITY;
+
+	for(int j = 0; j < N; j++){
+		max = x[j] + y[j] > max ? x[j] + y[j] : max;
+	}
+
+	return max == -INFINITY ? 0.0 : max;
+}
+
+//nonzero if some x[j] + y[j] is not -inf
+static int has_finite(const double* const x, const double* const y, const int N){
+
+	for(int j = 0; j < N; j++){
+		if(x[j] + y[j] != -INFINITY){
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+double sca_log_forward(const double* const la, const double* const lb, const double* const lp, const int* const y, double* const lalpha, const int N, const int T){
+
+	const int y0 = y[0];
+
+	//compute log alpha(0)
+	for(int s = 0; s < N; s++){
+		lalpha[s] = lp[s] + lb[y0*N + s];
+	}
+
+	//compute log alpha(t)
+	for(int t = 1; t < T; t++){
+		const double* const prev = lalpha + (size_t)(t-1)*N;
+		const int yt = y[t];
+
+		for(int s = 0; s < N; s++){
+			const double max = finite_max(prev, la + s*N, N);
+			double sum = 0.0;
+
+			for(int j = 0; j < N; j++){
+				sum += exp(prev[j] + la[s*N + j] - max);
+			}
+
+			lalpha[(size_t)t*N + s] = max + log(sum) + lb[yt*N + s];
+		}
+	}
+
+	//log P(y) = log-sum-exp of log alpha(T-1)
+	const double* const last = lalpha + (size_t)(T-1)*N;
+	double max = -INFINITY;
+	double sum = 0.0;
+
+	for(int s = 0; s < N; s++){
+		max = last[s] > max ? last[s] : max;
+	}
+
+	for(int s = 0; s < N; s++){
+		sum += exp(last[s] - max);
+	}
+
+	return max + log(sum);
+}
+
+void sca_log_backward(const double* const lab, const double* const lalpha, const double lnP, const int* const y, double* const lbeta, double* const lbeta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T){
+
+	double* beta_cur = lbeta;
+	double* beta_nxt = lbeta_new;
+	int yt = y[T-1];
+
+	//log beta(T-1) = 0, gamma(T-1) = alpha(T-1) / P(y)
+	for(int s = 0; s < N; s++){
+		const double gammas = exp(lalpha[(size_t)(T-1)*N + s] - lnP);
+
+		beta_cur[s] = 0.0;
+		gamma0[s] = gammas;
+		gamma_T[s] += gammas;
+		b_new[yt*N + s] += gammas;
+	}
+
+	for(int t = T-1; t > 0; t--){
+		const int yt1 = y[t-1];
+
+		for(int s = 0; s < N; s++){
+			const double* const labs = lab + (yt*N + s)*N;
+			const double max = finite_max(beta_cur, labs, N);
+
+			//no term is finite (s can not reach any state that explains the rest, e.g. outside of a band):
+			//beta is 0 and so are xi and gamma, scale would overflow to inf and inf * 0 is NaN
+			if(max == 0.0 && !has_finite(beta_cur, labs, N)){
+				beta_nxt[s] = -INFINITY;
+				gamma0[s] = 0.0;
+				continue;
+			}
+
+			//xi(t-1)(s,j) = scale * exp(lab(s,j) + log beta(t)(j) - max)
+			const double scale = exp(lalpha[(size_t)(t-1)*N + s] + max - lnP);
+			double sum = 0.0;
+
+			for(int j = 0; j < N; j++){
+				const double e = exp(beta_cur[j] + labs[j] - max);
+				a_new[s*N + j] += scale * e;
+				sum += e;
+			}
+
+			const double ps = scale * sum;
+
+			beta_nxt[s] = max + log(sum);
+			gamma0[s] = ps;
+			gamma_sum[s] += ps;
+			b_new[yt1*N + s] += ps;
+		}
+
+		double* temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt = yt1;
+	}
+
+	sca_add(p_new, gamma0, 1, N);
+}
+
+const kernels sca_kernels = {
+	.name = "scalar",
+	.simd = 0,
+	.transpose = sca_transpose,
+	.forward = sca_forward,
+	.forward_steps = sca_forward_steps,
+	.chunk_product = sca_chunk_product,
+	.stitch = sca_stitch,
+	.build_ab = sca_build_ab,
+	.backward = sca_backward,
+	.backward_init = sca_backward_init,
+	.backward_steps = sca_backward_steps,
+	.backward_steps_otf = sca_backward_steps_otf,
+	.backward_blocked = sca_backward_blocked,
+	.update = sca_update,
+	.zero = sca_zero,
+	.add = sca_add,
+	.log_likelihood = sca_log_likelihood,
+	.mix_forward = NULL,
+	.mix_backward = NULL,
+	.logarithm = sca_logarithm,
+	.log_forward = sca_log_forward,
+	.log_backward = sca_log_backward
+};
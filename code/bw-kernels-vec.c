@@ -0,0 +1,704 @@
+#include <math.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "bw-kernels.h"
+
+//horizontal sum of the four lanes, broadcasted into all lanes
+static inline __m256d reduce_vec(const __m256d x){
+
+	__m256d perm = _mm256_permute2f128_pd(x,x,0b00000011);
+
+	__m256d shuffle1 = _mm256_shuffle_pd(x, perm, 0b0101);
+	__m256d shuffle2 = _mm256_shuffle_pd(perm, x, 0b0101);
+
+	__m256d x_add = _mm256_add_pd(x, perm);
+	__m256d x_temp = _mm256_add_pd(shuffle1, shuffle2);
+
+	return _mm256_add_pd(x_add, x_temp);
+}
+
+void vec_transpose(double* const a, const int N){
+
+	for(int by = 0; by < N; by+=4){
+
+		//Diagonal block
+		__m256d diag0 = _mm256_load_pd(a + by*N + by);
+		__m256d diag1 = _mm256_load_pd(a + (by+1)*N + by);
+		__m256d diag2 = _mm256_load_pd(a + (by+2)*N + by);
+		__m256d diag3 = _mm256_load_pd(a + (by+3)*N + by);
+
+		__m256d tmp0 = _mm256_shuffle_pd(diag0,diag1, 0x0);
+		__m256d tmp1 = _mm256_shuffle_pd(diag2,diag3, 0x0);
+		__m256d tmp2 = _mm256_shuffle_pd(diag0,diag1, 0xF);
+		__m256d tmp3 = _mm256_shuffle_pd(diag2,diag3, 0xF);
+
+		__m256d row0 = _mm256_permute2f128_pd(tmp0, tmp1, 0x20);
+		__m256d row1 = _mm256_permute2f128_pd(tmp2, tmp3, 0x20);
+		__m256d row2 = _mm256_permute2f128_pd(tmp0, tmp1, 0x31);
+		__m256d row3 = _mm256_permute2f128_pd(tmp2, tmp3, 0x31);
+
+		_mm256_store_pd(a + by*N + by,row0);
+		_mm256_store_pd(a + (by+1)*N + by,row1);
+		_mm256_store_pd(a + (by+2)*N + by,row2);
+		_mm256_store_pd(a + (by+3)*N + by,row3);
+
+		//Offdiagonal blocks
+		for(int bx = by + 4; bx < N; bx+= 4){
+
+			__m256d upper0 = _mm256_load_pd(a + by*N + bx);
+			__m256d upper1 = _mm256_load_pd(a + (by+1)*N + bx);
+			__m256d upper2 = _mm256_load_pd(a + (by+2)*N + bx);
+			__m256d upper3 = _mm256_load_pd(a + (by+3)*N + bx);
+
+			__m256d lower0 = _mm256_load_pd(a + bx * N + by);
+			__m256d lower1 = _mm256_load_pd(a + (bx+1)*N + by);
+			__m256d lower2 = _mm256_load_pd(a + (bx+2)*N + by);
+			__m256d lower3 = _mm256_load_pd(a + (bx+3)*N + by);
+
+			__m256d utmp0 = _mm256_shuffle_pd(upper0,upper1, 0x0);
+			__m256d utmp1 = _mm256_shuffle_pd(upper2,upper3, 0x0);
+			__m256d utmp2 = _mm256_shuffle_pd(upper0,upper1, 0xF);
+			__m256d utmp3 = _mm256_shuffle_pd(upper2,upper3, 0xF);
+
+			__m256d ltmp0 = _mm256_shuffle_pd(lower0,lower1, 0x0);
+			__m256d ltmp1 = _mm256_shuffle_pd(lower2,lower3, 0x0);
+			__m256d ltmp2 = _mm256_shuffle_pd(lower0,lower1, 0xF);
+			__m256d ltmp3 = _mm256_shuffle_pd(lower2,lower3, 0xF);
+
+			__m256d urow0 = _mm256_permute2f128_pd(utmp0, utmp1, 0x20);
+			__m256d urow1 = _mm256_permute2f128_pd(utmp2, utmp3, 0x20);
+			__m256d urow2 = _mm256_permute2f128_pd(utmp0, utmp1, 0x31);
+			__m256d urow3 = _mm256_permute2f128_pd(utmp2, utmp3, 0x31);
+
+			__m256d lrow0 = _mm256_permute2f128_pd(ltmp0, ltmp1, 0x20);
+			__m256d lrow1 = _mm256_permute2f128_pd(ltmp2, ltmp3, 0x20);
+			__m256d lrow2 = _mm256_permute2f128_pd(ltmp0, ltmp1, 0x31);
+			__m256d lrow3 = _mm256_permute2f128_pd(ltmp2, ltmp3, 0x31);
+
+			_mm256_store_pd(a + by*N + bx,lrow0);
+			_mm256_store_pd(a + (by+1)*N + bx,lrow1);
+			_mm256_store_pd(a + (by+2)*N + bx,lrow2);
+			_mm256_store_pd(a + (by+3)*N + bx,lrow3);
+
+			_mm256_store_pd(a + bx*N + by,urow0);
+			_mm256_store_pd(a + (bx+1)*N + by,urow1);
+			_mm256_store_pd(a + (bx+2)*N + by,urow2);
+			_mm256_store_pd(a + (bx+3)*N + by,urow3);
+		}
+	}
+}
+
+void vec_forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T){
+
+	__m256d one = _mm256_set1_pd(1.0);
+	int y0 = y[0];
+	__m256d ct0_vec = _mm256_setzero_pd();
+
+	//compute alpha(0)
+	for(int s = 0; s < N; s+=4){
+		__m256d stateProb_vec = _mm256_load_pd(p +s);
+		__m256d emission_vec = _mm256_load_pd(b +y0*N +s);
+		__m256d alphas_vec = _mm256_mul_pd(stateProb_vec, emission_vec);
+		ct0_vec = _mm256_fmadd_pd(stateProb_vec,emission_vec, ct0_vec);
+		_mm256_store_pd(alpha+s,alphas_vec);
+	}
+
+	__m256d ct0_vec_div = _mm256_div_pd(one, reduce_vec(ct0_vec));
+	ct[0] = _mm256_cvtsd_f64(ct0_vec_div);
+
+	for(int s = 0; s < N; s+=4){
+		__m256d alphas=_mm256_load_pd(alpha+s);
+		_mm256_store_pd(alpha+s,_mm256_mul_pd(alphas,ct0_vec_div));
+	}
+
+	vec_forward_steps(a, b, y, alpha, alpha + N, ct, N, 1, T);
+}
+
+void vec_forward_steps(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last){
+
+	__m256d one = _mm256_set1_pd(1.0);
+	const double* alpha_prev = start;
+
+	//compute alpha(t)
+	for(int t = first; t < last; t++){
+		__m256d ctt_vec = _mm256_setzero_pd();
+		const int yt = y[t];
+
+		for(int s = 0; s<N; s+=4){
+
+			__m256d alphatNs0 = _mm256_setzero_pd();
+			__m256d alphatNs1 = _mm256_setzero_pd();
+			__m256d alphatNs2 = _mm256_setzero_pd();
+			__m256d alphatNs3 = _mm256_setzero_pd();
+
+			for(int j = 0; j < N; j+=4){
+				__m256d alphaFactor=_mm256_load_pd(alpha_prev+j);
+
+				__m256d transition0=_mm256_load_pd(a+(s)*N+j);
+				__m256d transition1=_mm256_load_pd(a+(s+1)*N+j);
+				__m256d transition2=_mm256_load_pd(a+(s+2)*N+j);
+				__m256d transition3=_mm256_load_pd(a+(s+3)*N+j);
+
+				alphatNs0 =_mm256_fmadd_pd(alphaFactor,transition0,alphatNs0);
+				alphatNs1 =_mm256_fmadd_pd(alphaFactor,transition1,alphatNs1);
+				alphatNs2 =_mm256_fmadd_pd(alphaFactor,transition2,alphatNs2);
+				alphatNs3 =_mm256_fmadd_pd(alphaFactor,transition3,alphatNs3);
+			}
+
+			__m256d emission = _mm256_load_pd(b + yt*N + s);
+
+			__m256d alpha01 = _mm256_hadd_pd(alphatNs0, alphatNs1);
+			__m256d alpha23 = _mm256_hadd_pd(alphatNs2, alphatNs3);
+
+			__m256d permute01 = _mm256_permute2f128_pd(alpha01, alpha23, 0b00110000);
+			__m256d permute23 = _mm256_permute2f128_pd(alpha01, alpha23, 0b00100001);
+
+			__m256d alpha_tot = _mm256_add_pd(permute01, permute23);
+			__m256d alpha_tot_mul = _mm256_mul_pd(alpha_tot,emission);
+
+			ctt_vec = _mm256_add_pd(alpha_tot_mul,ctt_vec);
+
+			_mm256_store_pd(alpha + (size_t)(t-first)*N + s,alpha_tot_mul);
+		}
+
+		__m256d ctt_vec_div = _mm256_div_pd(one, reduce_vec(ctt_vec));
+		ct[t] = _mm256_cvtsd_f64(ctt_vec_div);
+
+		for(int s = 0; s<N; s+=4){
+			__m256d alphas=_mm256_load_pd(alpha+(size_t)(t-first)*N+s);
+			_mm256_store_pd(alpha+(size_t)(t-first)*N+s,_mm256_mul_pd(alphas,ctt_vec_div));
+		}
+
+		alpha_prev = alpha + (size_t)(t-first)*N;
+	}
+}
+
+//scale the N*M doubles of a to sum 1
+static void normalize(double* const a, const int N, const int M){
+
+	__m256d sum_vec = _mm256_setzero_pd();
+
+	for(int i = 0; i < N*M; i+=4){
+		sum_vec = _mm256_add_pd(sum_vec, _mm256_load_pd(a + i));
+	}
+
+	__m256d sum_div = _mm256_div_pd(_mm256_set1_pd(1.0), reduce_vec(sum_vec));
+
+	for(int i = 0; i < N*M; i+=4){
+		_mm256_store_pd(a + i, _mm256_mul_pd(_mm256_load_pd(a + i), sum_div));
+	}
+}
+
+void vec_chunk_product(const double* const ab, const int* const y, double* const product, double* const scratch, const int N, const int first, const int last){
+
+	double* cur = product;
+	double* nxt = scratch;
+
+	memcpy(cur, ab + y[first]*N*N, N * N * sizeof(double));
+	normalize(cur, N, N);
+
+	for(int t = first + 1; t < last; t++){
+		const double* const abt = ab + y[t]*N*N;
+
+		//nxt = cur * ab(y(t)), 4 x 4 register blocks
+		for(int s = 0; s < N; s+=4){
+			for(int j = 0; j < N; j+=4){
+
+				__m256d nxt0 = _mm256_setzero_pd();
+				__m256d nxt1 = _mm256_setzero_pd();
+				__m256d nxt2 = _mm256_setzero_pd();
+				__m256d nxt3 = _mm256_setzero_pd();
+
+				for(int k = 0; k < N; k++){
+					__m256d abtk = _mm256_load_pd(abt + k*N + j);
+
+					nxt0 = _mm256_fmadd_pd(_mm256_set1_pd(cur[s*N + k]), abtk, nxt0);
+					nxt1 = _mm256_fmadd_pd(_mm256_set1_pd(cur[(s+1)*N + k]), abtk, nxt1);
+					nxt2 = _mm256_fmadd_pd(_mm256_set1_pd(cur[(s+2)*N + k]), abtk, nxt2);
+					nxt3 = _mm256_fmadd_pd(_mm256_set1_pd(cur[(s+3)*N + k]), abtk, nxt3);
+				}
+
+				_mm256_store_pd(nxt + s*N + j, nxt0);
+				_mm256_store_pd(nxt + (s+1)*N + j, nxt1);
+				_mm256_store_pd(nxt + (s+2)*N + j, nxt2);
+				_mm256_store_pd(nxt + (s+3)*N + j, nxt3);
+			}
+		}
+
+		//the scale cancels out when alpha gets normalized
+		normalize(nxt, N, N);
+
+		double* tmp = cur;
+		cur = nxt;
+		nxt = tmp;
+	}
+
+	if(cur != product){
+		memcpy(product, cur, N * N * sizeof(double));
+	}
+}
+
+void vec_stitch(const double* const start, const double* const product, double* const next, const int N){
+
+	vec_zero(next, 1, N);
+
+	for(int k = 0; k < N; k++){
+		__m256d startk = _mm256_set1_pd(start[k]);
+
+		for(int j = 0; j < N; j+=4){
+			__m256d nextj = _mm256_load_pd(next + j);
+			_mm256_store_pd(next + j, _mm256_fmadd_pd(startk, _mm256_load_pd(product + k*N + j), nextj));
+		}
+	}
+
+	normalize(next, 1, N);
+}
+
+void vec_build_ab(const double* const a, const double* const b, double* const ab, const int N, const int K){
+
+	for(int v = 0; v < K; v++){
+		for(int s = 0; s < N; s+=4){
+			for(int j = 0; j < N; j+=4){
+				__m256d transition0 = _mm256_load_pd(a+ s * N+j);
+				__m256d transition1 = _mm256_load_pd(a+ (s+1) * N+j);
+				__m256d transition2 = _mm256_load_pd(a+ (s+2) * N+j);
+				__m256d transition3 = _mm256_load_pd(a+ (s+3) * N+j);
+
+				__m256d emission0 = _mm256_load_pd(b + v * N+j);
+
+				_mm256_store_pd(ab +(v*N + s) * N + j, _mm256_mul_pd(transition0,emission0));
+				_mm256_store_pd(ab +(v*N + s+1) * N + j, _mm256_mul_pd(transition1,emission0));
+				_mm256_store_pd(ab +(v*N + s+2) * N + j, _mm256_mul_pd(transition2,emission0));
+				_mm256_store_pd(ab +(v*N + s+3) * N + j, _mm256_mul_pd(transition3,emission0));
+			}
+		}
+	}
+}
+
+void vec_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T){
+
+	vec_backward_init(alpha + (size_t)(T-1)*N, ct, y, beta, gamma0, gamma_T, b_new, N, T);
+	vec_backward_steps(ab, alpha, ct, y, beta, beta_new, gamma0, gamma_sum, a_new, b_new, N, 0, T-1);
+	vec_add(p_new, gamma0, 1, N);
+}
+
+void vec_backward_init(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T){
+
+	__m256d ctT_vec = _mm256_set1_pd(ct[T-1]);
+	int yt = y[T-1];
+
+	//gamma(T-1) = alpha(T-1)
+	for(int s = 0; s < N; s+=4){
+		__m256d alphaT1Ns = _mm256_load_pd(alphaT1 + s);
+		__m256d gamma_Ts = _mm256_load_pd(gamma_T + s);
+		__m256d b_new_vec = _mm256_load_pd(b_new + yt*N + s);
+
+		_mm256_store_pd(beta + s, ctT_vec);
+		_mm256_store_pd(gamma0 + s, alphaT1Ns);
+		_mm256_store_pd(gamma_T + s, _mm256_add_pd(gamma_Ts, alphaT1Ns));
+		_mm256_store_pd(b_new + yt*N + s, _mm256_add_pd(b_new_vec, alphaT1Ns));
+	}
+}
+
+//one step of vec_backward_steps: beta_nxt, gamma and the sums of xi out of beta_cur
+//abt is the N x N block of a*b of the current observation
+static void backward_step(const double* const abt, const double* const alphat1, const double ctt, const int yt1, const double* const beta_cur, double* const beta_nxt, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N){
+
+	__m256d ctt_vec = _mm256_set1_pd(ctt);
+
+	for(int s = 0; s < N ; s+=4){
+		__m256d alphat1Ns0_vec = _mm256_set1_pd(alphat1[s]);
+		__m256d alphat1Ns1_vec = _mm256_set1_pd(alphat1[s+1]);
+		__m256d alphat1Ns2_vec = _mm256_set1_pd(alphat1[s+2]);
+		__m256d alphat1Ns3_vec = _mm256_set1_pd(alphat1[s+3]);
+
+		__m256d beta_news0 = _mm256_setzero_pd();
+		__m256d beta_news1 = _mm256_setzero_pd();
+		__m256d beta_news2 = _mm256_setzero_pd();
+		__m256d beta_news3 = _mm256_setzero_pd();
+
+		__m256d alphatNs = _mm256_load_pd(alphat1 + s);
+
+		for(int j = 0; j < N; j+=4){
+			__m256d beta_vec = _mm256_load_pd(beta_cur+j);
+
+			__m256d abs0 = _mm256_load_pd(abt + s*N + j);
+			__m256d abs1 = _mm256_load_pd(abt + (s+1)*N + j);
+			__m256d abs2 = _mm256_load_pd(abt + (s+2)*N + j);
+			__m256d abs3 = _mm256_load_pd(abt + (s+3)*N + j);
+
+			__m256d temp = _mm256_mul_pd(abs0,beta_vec);
+			__m256d temp1 = _mm256_mul_pd(abs1,beta_vec);
+			__m256d temp2 = _mm256_mul_pd(abs2,beta_vec);
+			__m256d temp3 = _mm256_mul_pd(abs3,beta_vec);
+
+			__m256d a_new_vec = _mm256_load_pd(a_new + s*N+j);
+			__m256d a_new_vec1 = _mm256_load_pd(a_new + (s+1)*N+j);
+			__m256d a_new_vec2 = _mm256_load_pd(a_new + (s+2)*N+j);
+			__m256d a_new_vec3 = _mm256_load_pd(a_new + (s+3)*N+j);
+
+			_mm256_store_pd(a_new + s*N+j,_mm256_fmadd_pd(alphat1Ns0_vec, temp,a_new_vec));
+			_mm256_store_pd(a_new + (s+1)*N+j,_mm256_fmadd_pd(alphat1Ns1_vec, temp1,a_new_vec1));
+			_mm256_store_pd(a_new + (s+2)*N+j,_mm256_fmadd_pd(alphat1Ns2_vec, temp2,a_new_vec2));
+			_mm256_store_pd(a_new + (s+3)*N+j,_mm256_fmadd_pd(alphat1Ns3_vec, temp3,a_new_vec3));
+
+			beta_news0 = _mm256_add_pd(beta_news0,temp);
+			beta_news1 = _mm256_add_pd(beta_news1,temp1);
+			beta_news2 = _mm256_add_pd(beta_news2,temp2);
+			beta_news3 = _mm256_add_pd(beta_news3,temp3);
+		}
+
+		__m256d gamma_sum_vec = _mm256_load_pd(gamma_sum + s);
+		__m256d b_new_vec = _mm256_load_pd(b_new +yt1*N+ s);
+
+		__m256d beta01 = _mm256_hadd_pd(beta_news0, beta_news1);
+		__m256d beta23 = _mm256_hadd_pd(beta_news2, beta_news3);
+
+		__m256d permute01 = _mm256_permute2f128_pd(beta01, beta23, 0b00110000);
+		__m256d permute23 = _mm256_permute2f128_pd(beta01, beta23, 0b00100001);
+
+		__m256d beta_news = _mm256_add_pd(permute01, permute23);
+
+		__m256d ps = _mm256_mul_pd(alphatNs, beta_news);
+
+		_mm256_store_pd(gamma0 + s, ps);
+		_mm256_store_pd(beta_nxt + s, _mm256_mul_pd(beta_news, ctt_vec));
+		_mm256_store_pd(gamma_sum+s, _mm256_add_pd(gamma_sum_vec, ps));
+		_mm256_store_pd(b_new +yt1*N+ s, _mm256_add_pd(b_new_vec, ps));
+	}
+}
+
+void vec_backward_steps(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	int yt = y[last];
+
+	for(int t = last; t > first; t--){
+		const int yt1 = y[t-1];
+
+		backward_step(ab + yt*N*N, alpha + (size_t)(t-1-first)*N, ct[t-1], yt1, beta_cur, beta_nxt, gamma0, gamma_sum, a_new, b_new, N);
+
+		double * temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt=yt1;
+	}
+
+	//leave beta(first) in beta
+	if(beta_cur != beta){
+		memcpy(beta, beta_cur, N * sizeof(double));
+	}
+}
+
+void vec_backward_steps_otf(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+	int yt = y[last];
+
+	for(int t = last; t > first; t--){
+		const int yt1 = y[t-1];
+
+		//a(s,j)*b(yt,j)*beta(j) = a(s,j)*(b(yt,j)*beta(j)), beta_cur is not needed afterwards
+		for(int j = 0; j < N; j+=4){
+			_mm256_store_pd(beta_cur + j, _mm256_mul_pd(_mm256_load_pd(beta_cur + j), _mm256_load_pd(b + yt*N + j)));
+		}
+
+		backward_step(a, alpha + (size_t)(t-1-first)*N, ct[t-1], yt1, beta_cur, beta_nxt, gamma0, gamma_sum, a_new, b_new, N);
+
+		double * temp = beta_nxt;
+		beta_nxt = beta_cur;
+		beta_cur = temp;
+		yt=yt1;
+	}
+
+	//leave beta(first) in beta
+	if(beta_cur != beta){
+		memcpy(beta, beta_cur, N * sizeof(double));
+	}
+}
+
+//beta_new = a * w for the N x N matrix a, 4 rows at a time
+static void gemv(const double* const a, const double* const w, double* const beta_new, const int N){
+
+	for(int s = 0; s < N; s+=4){
+		__m256d sum0 = _mm256_setzero_pd();
+		__m256d sum1 = _mm256_setzero_pd();
+		__m256d sum2 = _mm256_setzero_pd();
+		__m256d sum3 = _mm256_setzero_pd();
+
+		for(int j = 0; j < N; j+=4){
+			__m256d w_vec = _mm256_load_pd(w + j);
+
+			sum0 = _mm256_fmadd_pd(_mm256_load_pd(a + s*N + j), w_vec, sum0);
+			sum1 = _mm256_fmadd_pd(_mm256_load_pd(a + (s+1)*N + j), w_vec, sum1);
+			sum2 = _mm256_fmadd_pd(_mm256_load_pd(a + (s+2)*N + j), w_vec, sum2);
+			sum3 = _mm256_fmadd_pd(_mm256_load_pd(a + (s+3)*N + j), w_vec, sum3);
+		}
+
+		__m256d sum01 = _mm256_hadd_pd(sum0, sum1);
+		__m256d sum23 = _mm256_hadd_pd(sum2, sum3);
+
+		__m256d permute01 = _mm256_permute2f128_pd(sum01, sum23, 0b00110000);
+		__m256d permute23 = _mm256_permute2f128_pd(sum01, sum23, 0b00100001);
+
+		_mm256_store_pd(beta_new + s, _mm256_add_pd(permute01, permute23));
+	}
+}
+
+//c += x^T * w for x and w with rows rows of N doubles (N x N result)
+//blocks of 4 x 8 of c stay in 8 registers over all rows, 8 fmas per 2 loads and 4 broadcasts
+static void gemm_tn(const double* const x, const double* const w, double* const c, const int rows, const int N){
+
+	for(int s = 0; s < N; s+=4){
+		int j = 0;
+
+		for(; j + 8 <= N; j+=8){
+			__m256d c00 = _mm256_setzero_pd();
+			__m256d c01 = _mm256_setzero_pd();
+			__m256d c10 = _mm256_setzero_pd();
+			__m256d c11 = _mm256_setzero_pd();
+			__m256d c20 = _mm256_setzero_pd();
+			__m256d c21 = _mm256_setzero_pd();
+			__m256d c30 = _mm256_setzero_pd();
+			__m256d c31 = _mm256_setzero_pd();
+
+			for(int i = 0; i < rows; i++){
+				__m256d w0 = _mm256_load_pd(w + i*N + j);
+				__m256d w1 = _mm256_load_pd(w + i*N + j+4);
+
+				__m256d x0 = _mm256_set1_pd(x[i*N + s]);
+				__m256d x1 = _mm256_set1_pd(x[i*N + s+1]);
+				__m256d x2 = _mm256_set1_pd(x[i*N + s+2]);
+				__m256d x3 = _mm256_set1_pd(x[i*N + s+3]);
+
+				c00 = _mm256_fmadd_pd(x0, w0, c00);
+				c01 = _mm256_fmadd_pd(x0, w1, c01);
+				c10 = _mm256_fmadd_pd(x1, w0, c10);
+				c11 = _mm256_fmadd_pd(x1, w1, c11);
+				c20 = _mm256_fmadd_pd(x2, w0, c20);
+				c21 = _mm256_fmadd_pd(x2, w1, c21);
+				c30 = _mm256_fmadd_pd(x3, w0, c30);
+				c31 = _mm256_fmadd_pd(x3, w1, c31);
+			}
+
+			_mm256_store_pd(c + s*N + j, _mm256_add_pd(_mm256_load_pd(c + s*N + j), c00));
+			_mm256_store_pd(c + s*N + j+4, _mm256_add_pd(_mm256_load_pd(c + s*N + j+4), c01));
+			_mm256_store_pd(c + (s+1)*N + j, _mm256_add_pd(_mm256_load_pd(c + (s+1)*N + j), c10));
+			_mm256_store_pd(c + (s+1)*N + j+4, _mm256_add_pd(_mm256_load_pd(c + (s+1)*N + j+4), c11));
+			_mm256_store_pd(c + (s+2)*N + j, _mm256_add_pd(_mm256_load_pd(c + (s+2)*N + j), c20));
+			_mm256_store_pd(c + (s+2)*N + j+4, _mm256_add_pd(_mm256_load_pd(c + (s+2)*N + j+4), c21));
+			_mm256_store_pd(c + (s+3)*N + j, _mm256_add_pd(_mm256_load_pd(c + (s+3)*N + j), c30));
+			_mm256_store_pd(c + (s+3)*N + j+4, _mm256_add_pd(_mm256_load_pd(c + (s+3)*N + j+4), c31));
+		}
+
+		//N is a multiple of 4, at most one block of 4 columns left
+		if(j < N){
+			__m256d c0 = _mm256_setzero_pd();
+			__m256d c1 = _mm256_setzero_pd();
+			__m256d c2 = _mm256_setzero_pd();
+			__m256d c3 = _mm256_setzero_pd();
+
+			for(int i = 0; i < rows; i++){
+				__m256d w0 = _mm256_load_pd(w + i*N + j);
+
+				c0 = _mm256_fmadd_pd(_mm256_set1_pd(x[i*N + s]), w0, c0);
+				c1 = _mm256_fmadd_pd(_mm256_set1_pd(x[i*N + s+1]), w0, c1);
+				c2 = _mm256_fmadd_pd(_mm256_set1_pd(x[i*N + s+2]), w0, c2);
+				c3 = _mm256_fmadd_pd(_mm256_set1_pd(x[i*N + s+3]), w0, c3);
+			}
+
+			_mm256_store_pd(c + s*N + j, _mm256_add_pd(_mm256_load_pd(c + s*N + j), c0));
+			_mm256_store_pd(c + (s+1)*N + j, _mm256_add_pd(_mm256_load_pd(c + (s+1)*N + j), c1));
+			_mm256_store_pd(c + (s+2)*N + j, _mm256_add_pd(_mm256_load_pd(c + (s+2)*N + j), c2));
+			_mm256_store_pd(c + (s+3)*N + j, _mm256_add_pd(_mm256_load_pd(c + (s+3)*N + j), c3));
+		}
+	}
+}
+
+void vec_backward_blocked(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, double* const w, const int N, const int T, const int B){
+
+	double* beta_cur = beta;
+	double* beta_nxt = beta_new;
+
+	vec_backward_init(alpha + (size_t)(T-1)*N, ct, y, beta, gamma0, gamma_T, b_new, N, T);
+
+	//blocks of time steps lo...hi, row t-lo of w pairs with row t-1 of alpha
+	for(int hi = T-1; hi > 0; hi -= B){
+		const int lo = hi - B + 1 > 1 ? hi - B + 1 : 1;
+
+		for(int t = hi; t >= lo; t--){
+			double* const wt = w + (t-lo)*N;
+			const double* const alphat1 = alpha + (size_t)(t-1)*N;
+			__m256d ctt_vec = _mm256_set1_pd(ct[t-1]);
+			const int yt = y[t];
+			const int yt1 = y[t-1];
+
+			//w(t) = b(y(t)) * beta(t), beta(t-1) = a * w(t)
+			for(int j = 0; j < N; j+=4){
+				_mm256_store_pd(wt + j, _mm256_mul_pd(_mm256_load_pd(b + yt*N + j), _mm256_load_pd(beta_cur + j)));
+			}
+
+			gemv(a, wt, beta_nxt, N);
+
+			for(int s = 0; s < N; s+=4){
+				__m256d beta_news = _mm256_load_pd(beta_nxt + s);
+				__m256d ps = _mm256_mul_pd(_mm256_load_pd(alphat1 + s), beta_news);
+
+				_mm256_store_pd(gamma0 + s, ps);
+				_mm256_store_pd(beta_nxt + s, _mm256_mul_pd(beta_news, ctt_vec));
+				_mm256_store_pd(gamma_sum + s, _mm256_add_pd(_mm256_load_pd(gamma_sum + s), ps));
+				_mm256_store_pd(b_new + yt1*N + s, _mm256_add_pd(_mm256_load_pd(b_new + yt1*N + s), ps));
+			}
+
+			double* temp = beta_nxt;
+			beta_nxt = beta_cur;
+			beta_cur = temp;
+		}
+
+		//sums of xi of the block without the factor a
+		gemm_tn(alpha + (size_t)(lo-1)*N, w, a_new, hi - lo + 1, N);
+	}
+
+	vec_add(p_new, gamma0, 1, N);
+}
+
+void vec_update(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K){
+
+	__m256d one = _mm256_set1_pd(1.0);
+	__m256d sequences_inv = _mm256_set1_pd(1.0 / sequences);
+
+	//add remaining parts of the sum of gamma
+	for(int s = 0; s < N; s+=4){
+		__m256d gamma_Ts = _mm256_load_pd(gamma_T + s);
+		__m256d gamma_sums = _mm256_load_pd(gamma_sum + s);
+
+		__m256d gamma_tot = _mm256_add_pd(gamma_Ts, gamma_sums);
+
+		_mm256_store_pd(gamma_T+s,_mm256_div_pd(one,gamma_tot));
+		_mm256_store_pd(gamma_sum + s,_mm256_div_pd(one,gamma_sums));
+		_mm256_store_pd(p + s,_mm256_mul_pd(_mm256_load_pd(p_new + s),sequences_inv));
+	}
+
+	//compute new transition matrix
+	for(int s = 0; s < N; s+=4){
+
+		__m256d gamma_inv0 = _mm256_set1_pd(gamma_sum[s]);
+		__m256d gamma_inv1 = _mm256_set1_pd(gamma_sum[s+1]);
+		__m256d gamma_inv2 = _mm256_set1_pd(gamma_sum[s+2]);
+		__m256d gamma_inv3 = _mm256_set1_pd(gamma_sum[s+3]);
+
+		for(int j = 0; j < N; j+=4){
+			__m256d a_news = _mm256_load_pd(a_new + s *N+j);
+			__m256d a_news1 = _mm256_load_pd(a_new + (s+1) *N+j);
+			__m256d a_news2 = _mm256_load_pd(a_new + (s+2) *N+j);
+			__m256d a_news3 = _mm256_load_pd(a_new + (s+3) *N+j);
+
+			_mm256_store_pd(a + s*N+j, _mm256_mul_pd(a_news, gamma_inv0));
+			_mm256_store_pd(a + (s+1)*N+j, _mm256_mul_pd(a_news1, gamma_inv1));
+			_mm256_store_pd(a + (s+2)*N+j, _mm256_mul_pd(a_news2, gamma_inv2));
+			_mm256_store_pd(a + (s+3)*N+j, _mm256_mul_pd(a_news3, gamma_inv3));
+		}
+	}
+
+	//compute new emission matrix
+	for(int v = 0; v < K; v+=4){
+		for(int s = 0; s < N; s+=4){
+			__m256d gamma_Tv = _mm256_load_pd(gamma_T + s);
+
+			__m256d b_newv0 = _mm256_load_pd(b_new + v * N + s);
+			__m256d b_newv1 = _mm256_load_pd(b_new + (v+1) * N + s);
+			__m256d b_newv2 = _mm256_load_pd(b_new + (v+2) * N + s);
+			__m256d b_newv3 = _mm256_load_pd(b_new + (v+3) * N + s);
+
+			_mm256_store_pd(b + v *N + s, _mm256_mul_pd(b_newv0,gamma_Tv));
+			_mm256_store_pd(b + (v+1) *N + s, _mm256_mul_pd(b_newv1,gamma_Tv));
+			_mm256_store_pd(b + (v+2) *N + s, _mm256_mul_pd(b_newv2,gamma_Tv));
+			_mm256_store_pd(b + (v+3) *N + s, _mm256_mul_pd(b_newv3,gamma_Tv));
+		}
+	}
+}
+
+void vec_zero(double* const a, const int N, const int M){
+
+	__m256d zero = _mm256_setzero_pd();
+
+	for(int i = 0; i < N*M; i+=4){
+		_mm256_store_pd(a + i, zero);
+	}
+}
+
+void vec_add(double* const a, const double* const b, const int N, const int M){
+
+	for(int i = 0; i < N*M; i+=4){
+		_mm256_store_pd(a + i, _mm256_add_pd(_mm256_load_pd(a + i), _mm256_load_pd(b + i)));
+	}
+}
+
+//-sum log2(ct(t)) with one log2: four running products of the ct, each renormalized to [0.5,1) per step
+//by taking its exponent bits off into a 64 bit integer sum (frexp on the bits, 128 bit integers need no AVX2)
+double vec_log_likelihood(const double* const ct, const int T){
+
+	const __m128i bits = _mm_set1_epi64x(0x7ff0000000000000LL);
+	const __m128i half = _mm_set1_epi64x(0x3fe0000000000000LL);
+	__m128d mantissa0 = _mm_set1_pd(1.0);
+	__m128d mantissa1 = _mm_set1_pd(1.0);
+	__m128i exponent0 = _mm_setzero_si128();
+	__m128i exponent1 = _mm_setzero_si128();
+	int t = 0;
+
+	for(; t + 4 <= T; t += 4){
+		__m128i product0 = _mm_castpd_si128(_mm_mul_pd(mantissa0, _mm_loadu_pd(ct + t)));
+		__m128i product1 = _mm_castpd_si128(_mm_mul_pd(mantissa1, _mm_loadu_pd(ct + t + 2)));
+		exponent0 = _mm_add_epi64(exponent0, _mm_srli_epi64(_mm_and_si128(product0, bits), 52));
+		exponent1 = _mm_add_epi64(exponent1, _mm_srli_epi64(_mm_and_si128(product1, bits), 52));
+		mantissa0 = _mm_castsi128_pd(_mm_or_si128(_mm_andnot_si128(bits, product0), half));
+		mantissa1 = _mm_castsi128_pd(_mm_or_si128(_mm_andnot_si128(bits, product1), half));
+	}
+
+	//every step added a biased exponent, 1022 of it belongs to the mantissa in [0.5,1)
+	long long exponents[4];
+	double mantissas[4];
+	_mm_storeu_si128((__m128i*) exponents, exponent0);
+	_mm_storeu_si128((__m128i*) (exponents + 2), exponent1);
+	_mm_storeu_pd(mantissas, mantissa0);
+	_mm_storeu_pd(mantissas + 2, mantissa1);
+
+	long exponent = exponents[0] + exponents[1] + exponents[2] + exponents[3] - 1022L * t;
+	double mantissa = mantissas[0] * mantissas[1] * mantissas[2] * mantissas[3];
+
+	for(; t < T; t++){
+		int e;
+		mantissa = frexp(mantissa * ct[t], &e);
+		exponent += e;
+	}
+
+	return -(exponent + log2(mantissa));
+}
+
+const kernels vec_kernels = {
+	.name = "avx2",
+	.simd = 1,
+	.transpose = vec_transpose,
+	.forward = vec_forward,
+	.forward_steps = vec_forward_steps,
+	.chunk_product = vec_chunk_product,
+	.stitch = vec_stitch,
+	.build_ab = vec_build_ab,
+	.backward = vec_backward,
+	.backward_init = vec_backward_init,
+	.backward_steps = vec_backward_steps,
+	.backward_steps_otf = vec_backward_steps_otf,
+	.backward_blocked = vec_backward_blocked,
+	.update = vec_update,
+	.zero = vec_zero,
+	.add = vec_add,
+	.log_likelihood = vec_log_likelihood,
+	.mix_forward = mix_forward,
+	.mix_backward = mix_backward,
+	.logarithm = vec_logarithm,
+	.log_forward = vec_log_forward,
+	.log_backward = vec_log_backward
+};
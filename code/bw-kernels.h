@@ -0,0 +1,221 @@
+#ifndef KERNELS_FILE_
+#define KERNELS_FILE_
+
+//Kernels of the vectorized engine (bw-kernels-vec.c), used by bw-lib.c.
+//Layouts are the ones of bw-vec.c: a[s*N + j], b[v*N + s] (observable major), ab[(v*N + s)*N + j].
+//N and K have to be multiples of 4 and all arrays 32 byte aligned.
+
+//in place transpose of the N x N matrix a with 4x4 blocks
+void vec_transpose(double* const a, const int N);
+
+//scaled forward step on the transposed transition matrix
+//writes alpha (N*T) and ct (T)
+void vec_forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T);
+
+//scaled forward step for t = first...last-1, alpha(first-1) is taken from start
+//alpha points to the row of time first, ct to the row of time 0
+void vec_forward_steps(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last);
+
+//product of ab(y(first)) * ... * ab(y(last-1)) (N x N each), scaled to sum 1 after every step
+//scratch is N x N
+void vec_chunk_product(const double* const ab, const int* const y, double* const product, double* const scratch, const int N, const int first, const int last);
+
+//next = start * product, scaled to sum 1 (the alpha before the next chunk)
+void vec_stitch(const double* const start, const double* const product, double* const next, const int N);
+
+//ab[(v*N + s)*N + j] = a[s*N + j] * b[v*N + j]
+void vec_build_ab(const double* const a, const double* const b, double* const ab, const int N, const int K);
+
+//fused backward and update step of one sequence
+//adds the sums of xi to a_new, the sums of gamma (t = 0...T-2) to gamma_sum, gamma(T-1) to gamma_T,
+//gamma(t) to b_new and gamma(0) to p_new (gamma0 is scratch of size N)
+void vec_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+
+//the parts of vec_backward for alpha kept in segments:
+//beta(T-1) into beta and gamma(T-1) = alpha(T-1) into gamma0, gamma_T and b_new
+void vec_backward_init(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T);
+
+//backward steps t = last...first+1 taking beta(last) from beta and leaving beta(first) there
+//alpha points to the row of time first and has to hold the rows first...last-1
+void vec_backward_steps(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+
+//vec_backward_steps without ab: a and b are multiplied on the fly, b(y(t)) is folded into beta(t)
+//(overwritten, N more multiplications per step), so only a has to stay in cache
+void vec_backward_steps_otf(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+
+//vec_backward without ab and with the sums of xi done as matrix products over blocks of B time steps:
+//each step is beta(t-1) = a * w(t) with w(t) = b(y(t)) * beta(t) kept as row of w (B x N),
+//after each block a_new += alpha(block)^T * w, so a_new gets the sums of xi WITHOUT the factor a(s,j),
+//multiply it by a once all sequences are done
+void vec_backward_blocked(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, double* const w, const int N, const int T, const int B);
+
+//new model out of the sums of xi and gamma pooled over all sequences
+//gamma_sum and gamma_T get overwritten with their inverses
+void vec_update(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K);
+
+//set the N*M doubles of a to zero
+void vec_zero(double* const a, const int N, const int M);
+
+//a += b for N*M doubles
+void vec_add(double* const a, const double* const b, const int N, const int M);
+
+//-sum of log2(ct)
+double vec_log_likelihood(const double* const ct, const int T);
+
+//Mixed precision kernels (bw-kernels-mix.c), alpha is stored in float, everything else in double.
+//scratch is N doubles
+
+void mix_forward(const double* const a, const double* const b, const double* const p, const int* const y, float* const alpha, double* const ct, double* const scratch, const int N, const int T);
+
+void mix_backward(const double* const ab, const float* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+
+//Log domain kernels (bw-kernels-log.c), built with AVX2FLAGS.
+//They take the natural logs of the transposed transition matrix (la), of b, p and ab,
+//-inf for zero probabilities. The sums of xi and gamma they add to are plain probabilities.
+
+//in place natural log of the N*M doubles of a
+void vec_logarithm(double* const a, const int N, const int M);
+
+//forward step in the log domain, writes log alpha (N*T) and returns log P(y) (natural log)
+double vec_log_forward(const double* const la, const double* const lb, const double* const lp, const int* const y, double* const lalpha, const int N, const int T);
+
+//fused backward and update step in the log domain with the same sums as vec_backward
+//lbeta and lbeta_new are scratch of size N
+void vec_log_backward(const double* const lab, const double* const lalpha, const double lnP, const int* const y, double* const lbeta, double* const lbeta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+
+//Sparse transition kernels (bw-kernels-csr.c), a is kept as its nonzeros in CSR (row, col, val, nnz of them),
+//the forward step runs on the transposed pattern (trow, tcol, tval), tpos maps a nonzero of a to its place there.
+//ab and a_new hold one value per nonzero (K x nnz and nnz).
+
+//tval out of val and ab[v*nnz + k] = val[k] * b[v*N + col[k]]
+void csr_build(const double* const val, const int* const col, const int* const tpos, const double* const b, double* const tval, double* const ab, const int nnz, const int N, const int K);
+
+//scaled forward step, same as vec_forward in O(nnz) per step
+void csr_forward(const int* const trow, const int* const tcol, const double* const tval, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T);
+
+//fused backward and update step, same sums as vec_backward with the sums of xi of the nonzeros in a_new
+void csr_backward(const int* const row, const int* const col, const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int nnz, const int N, const int T);
+
+//new nonzeros, b and p out of the pooled sums, like vec_update
+void csr_update(double* const val, const int* const row, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K);
+
+//Banded transition kernels (bw-kernels-band.c, AVX2), a is kept as its diagonals -lower...upper:
+//diag[(k+lower)*N + s] = a(s, s+k), ab and a_new in the same layout (K x bands x N and bands x N).
+
+//ab of the band for each observable
+void band_build(const double* const diag, const double* const b, double* const ab, const int lower, const int upper, const int N, const int K);
+
+//scaled forward step, same as vec_forward in O(N*bands) per step
+void band_forward(const double* const diag, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int lower, const int upper, const int N, const int T);
+
+//fused backward and update step, same sums as vec_backward with the sums of xi of the band in a_new
+void band_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int lower, const int upper, const int N, const int T);
+
+//new band, b and p out of the pooled sums, like vec_update
+void band_update(double* const diag, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int lower, const int upper, const int N, const int K);
+
+//Single precision kernels (bw-kernels-flt.c), same layouts with 8 floats per register.
+//N has to be a multiple of 8.
+
+void flt_transpose(float* const a, const int N);
+
+void flt_forward(const float* const a, const float* const b, const float* const p, const int* const y, float* const alpha, float* const ct, const int N, const int T);
+
+void flt_build_ab(const float* const a, const float* const b, float* const ab, const int N, const int K);
+
+void flt_backward(const float* const ab, const float* const alpha, const float* const ct, const int* const y, float* const beta, float* const beta_new, float* const gamma0, float* const p_new, float* const gamma_sum, float* const gamma_T, float* const a_new, float* const b_new, const int N, const int T);
+
+void flt_update(float* const a, float* const b, float* const p, float* const gamma_sum, float* const gamma_T, const float* const p_new, const float* const a_new, const float* const b_new, const int sequences, const int N, const int K);
+
+void flt_zero(float* const a, const int N, const int M);
+
+void flt_add(float* const a, const float* const b, const int N, const int M);
+
+double flt_log_likelihood(const float* const ct, const int T);
+
+//Scalar kernels (bw-kernels-sca.c), same contracts as the vec_ ones, built without VECFLAGS.
+
+void sca_transpose(double* const a, const int N);
+
+void sca_forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T);
+
+void sca_forward_steps(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last);
+
+void sca_chunk_product(const double* const ab, const int* const y, double* const product, double* const scratch, const int N, const int first, const int last);
+
+void sca_stitch(const double* const start, const double* const product, double* const next, const int N);
+
+void sca_build_ab(const double* const a, const double* const b, double* const ab, const int N, const int K);
+
+void sca_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+
+void sca_backward_init(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T);
+
+void sca_backward_steps(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+
+void sca_backward_steps_otf(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+
+void sca_backward_blocked(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, double* const w, const int N, const int T, const int B);
+
+void sca_update(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K);
+
+void sca_zero(double* const a, const int N, const int M);
+
+void sca_add(double* const a, const double* const b, const int N, const int M);
+
+double sca_log_likelihood(const double* const ct, const int T);
+
+void sca_logarithm(double* const a, const int N, const int M);
+
+double sca_log_forward(const double* const la, const double* const lb, const double* const lp, const int* const y, double* const lalpha, const int N, const int T);
+
+void sca_log_backward(const double* const lab, const double* const lalpha, const double lnP, const int* const y, double* const lbeta, double* const lbeta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+
+//AVX-512 kernels (bw-kernels-512.c), same contracts as the vec_ ones, built with AVX512FLAGS.
+//The other entries of their family are the AVX2 kernels.
+
+void v512_forward(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T);
+
+void v512_forward_steps(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last);
+
+void v512_backward(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+
+void v512_backward_init(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T);
+
+void v512_backward_steps(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+
+void v512_backward_steps_otf(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+
+void v512_update(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K);
+
+//One family of double precision kernels, bw-lib.c picks one at startup (cpuid, BW_KERNELS).
+typedef struct {
+	const char* name;
+	int simd;	//AVX2 and FMA are there, so the float and mixed kernels can run as well
+	void (*transpose)(double* const a, const int N);
+	void (*forward)(const double* const a, const double* const b, const double* const p, const int* const y, double* const alpha, double* const ct, const int N, const int T);
+	void (*forward_steps)(const double* const a, const double* const b, const int* const y, const double* const start, double* const alpha, double* const ct, const int N, const int first, const int last);
+	void (*chunk_product)(const double* const ab, const int* const y, double* const product, double* const scratch, const int N, const int first, const int last);
+	void (*stitch)(const double* const start, const double* const product, double* const next, const int N);
+	void (*build_ab)(const double* const a, const double* const b, double* const ab, const int N, const int K);
+	void (*backward)(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+	void (*backward_init)(const double* const alphaT1, const double* const ct, const int* const y, double* const beta, double* const gamma0, double* const gamma_T, double* const b_new, const int N, const int T);
+	void (*backward_steps)(const double* const ab, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+	void (*backward_steps_otf)(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const gamma_sum, double* const a_new, double* const b_new, const int N, const int first, const int last);
+	void (*backward_blocked)(const double* const a, const double* const b, const double* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, double* const w, const int N, const int T, const int B);
+	void (*update)(double* const a, double* const b, double* const p, double* const gamma_sum, double* const gamma_T, const double* const p_new, const double* const a_new, const double* const b_new, const int sequences, const int N, const int K);
+	void (*zero)(double* const a, const int N, const int M);
+	void (*add)(double* const a, const double* const b, const int N, const int M);
+	double (*log_likelihood)(const double* const ct, const int T);
+	void (*mix_forward)(const double* const a, const double* const b, const double* const p, const int* const y, float* const alpha, double* const ct, double* const scratch, const int N, const int T);
+	void (*mix_backward)(const double* const ab, const float* const alpha, const double* const ct, const int* const y, double* const beta, double* const beta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+	void (*logarithm)(double* const a, const int N, const int M);
+	double (*log_forward)(const double* const la, const double* const lb, const double* const lp, const int* const y, double* const lalpha, const int N, const int T);
+	void (*log_backward)(const double* const lab, const double* const lalpha, const double lnP, const int* const y, double* const lbeta, double* const lbeta_new, double* const gamma0, double* const p_new, double* const gamma_sum, double* const gamma_T, double* const a_new, double* const b_new, const int N, const int T);
+} kernels;
+
+extern const kernels sca_kernels;
+extern const kernels vec_kernels;
+extern const kernels v512_kernels;
+
+#endif
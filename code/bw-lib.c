@@ -0,0 +1,1384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <immintrin.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "bw.h"
+#include "bw-kernels.h"
+
+#define ALIGNMENT 64
+
+//the kernels work on blocks of 4, so N and K are rounded up to multiples of 4
+//the padding states have no probability, no transitions and no emissions, they stay at zero
+struct bw_model {
+	int N;		//padded sizes, used by all kernels
+	int K;
+	int states;	//sizes of the caller
+	int observables;
+	double* a;	//N x N, row major
+	double* b;	//K x N, observable major like in bw-vec.c
+	double* p;	//N
+	int ab;		//BW_AB_* used by the last training
+};
+
+//buffers private to one worker of the expectation step
+//alpha and ct are sized for the longest sequence of the worker
+//with checkpoints alpha only holds one segment, in mixed precision it is scratch for one step
+typedef struct {
+	double* alpha;
+	float* alpha_mixed;	//alpha of BW_MIXED
+	double* checkpoints;	//alpha at the end of each segment
+	double* beta;
+	double* beta_new;
+	double* gamma0;
+	double* ct;
+	double* p_new;
+	double* gamma_sum;
+	double* gamma_T;
+	double* a_new;
+	double* b_new;
+	double* w;		//xi_block x N, b * beta of the steps of one block
+	double logLikelihood;
+	int first;	//sequences [first, last) belong to this worker
+	int last;
+} worker;
+
+//buffers of one training run
+typedef struct {
+	double* at;
+	double* ab;
+	int ab_mode;		//BW_AB_FULL, BW_AB_PRESENT or BW_AB_ON_THE_FLY (no ab, the backward step multiplies a and b)
+	int K;			//observables the kernels see, with BW_AB_PRESENT only the ones that occur (padded)
+	double* b;		//b the kernels see, model->b or its rows of the observables that occur
+	int present;		//observables that occur
+	int* symbols;		//observable of each row of b
+	int* yc;		//the sequences in rows of b
+	const int** ys;
+	worker* workers;
+	int threads;
+	int time_parallel;	//threads split the forward step of each sequence in time
+	int checkpoint;		//keep alpha only every segment_length(T) steps
+	int mixed;		//keep alpha in float
+	int xi_block;		//time steps per matrix product of the blocked backward step, 0 for one step at a time
+	int log_space;		//at and ab hold their natural logs, alpha and beta are log alpha and log beta
+	double* lb;		//log b and log p of the log domain
+	double* lp;
+	int sparse;		//a as its nonzeros in CSR, ab and the a_new of the workers hold one value per nonzero
+	int nnz;
+	int a_size;		//doubles of a_new, N x N or nnz rounded up to a multiple of 4
+	int* row;		//N+1 offsets of the rows into col and val
+	int* col;
+	double* val;
+	int* trow;		//same for the transposed, used by the forward step
+	int* tcol;
+	int* tpos;		//place of each nonzero in the transposed
+	double* tval;
+	int banded;		//a as its diagonals -lower...upper, ab and a_new in the same layout
+	int lower;
+	int upper;
+	double* diag;
+	double* products;	//threads x N x N, products of ab over the chunks
+	double* scratch;	//threads x N x N
+	double* starts;		//threads x N, alpha before each chunk
+	pthread_barrier_t barrier;
+	bw_model* model;
+	const int* const* y;
+	const int* T;
+} workspace;
+
+//argument of the threads of the expectation step
+typedef struct {
+	workspace* ws;
+	int id;
+} worker_arg;
+
+//kernel family of this process, picked once by select_engine
+static const kernels* engine = NULL;
+static pthread_once_t engine_once = PTHREAD_ONCE_INIT;
+
+//best family the cpu supports, BW_KERNELS=scalar|avx2|avx512 overrides it (unsupported choices are ignored)
+static void pick_engine(void){
+
+	__builtin_cpu_init();
+	const int avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	const int avx512 = avx2 && __builtin_cpu_supports("avx512f");
+	const char* const choice = getenv("BW_KERNELS");
+
+	engine = avx512 ? &v512_kernels : avx2 ? &vec_kernels : &sca_kernels;
+
+	if(choice != NULL){
+		if(strcmp(choice, "scalar") == 0){
+			engine = &sca_kernels;
+		}else if(strcmp(choice, "avx2") == 0 && avx2){
+			engine = &vec_kernels;
+		}else if(strcmp(choice, "avx512") == 0 && avx512){
+			engine = &v512_kernels;
+		}
+	}
+}
+
+static void select_engine(void){
+	pthread_once(&engine_once, pick_engine);
+}
+
+const char* bw_kernels(void){
+	select_engine();
+	return engine->name;
+}
+
+void bw_options_init(bw_options* const options){
+	options->epsilon = 1e-4;
+	options->max_steps = 0;
+	options->threads = 1;
+	options->time_parallel = 0;
+	options->checkpoint = 0;
+	options->precision = BW_DOUBLE;
+	options->log_space = 0;
+	options->sparse = 0;
+	options->banded = 0;
+	options->xi_block = 0;
+	options->ab = BW_AB_AUTO;
+}
+
+//round up to the block size of the kernels
+static int padded(const int n){
+	return (n + 3) & ~3;
+}
+
+bw_model* bw_model_create(const int states, const int observables){
+
+	if(states <= 0 || observables <= 0){
+		return NULL;
+	}
+
+	const int N = padded(states);
+	const int K = padded(observables);
+
+	bw_model* model = (bw_model*) malloc(sizeof(bw_model));
+
+	if(model == NULL){
+		return NULL;
+	}
+
+	model->N = N;
+	model->K = K;
+	model->states = states;
+	model->observables = observables;
+	model->ab = BW_AB_AUTO;
+	model->a = (double*) _mm_malloc(N * N * sizeof(double),ALIGNMENT);
+	model->b = (double*) _mm_malloc(K * N * sizeof(double),ALIGNMENT);
+	model->p = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+
+	if(model->a == NULL || model->b == NULL || model->p == NULL){
+		bw_model_free(model);
+		return NULL;
+	}
+
+	memset(model->a, 0, N * N * sizeof(double));
+	memset(model->b, 0, K * N * sizeof(double));
+	memset(model->p, 0, N * sizeof(double));
+
+	return model;
+}
+
+void bw_model_free(bw_model* const model){
+
+	if(model == NULL){
+		return;
+	}
+
+	_mm_free(model->a);
+	_mm_free(model->b);
+	_mm_free(model->p);
+	free(model);
+}
+
+int bw_model_states(const bw_model* const model){
+	return model->states;
+}
+
+int bw_model_observables(const bw_model* const model){
+	return model->observables;
+}
+
+int bw_model_ab(const bw_model* const model){
+	return model->ab;
+}
+
+void bw_model_set(bw_model* const model, const double* const transitionMatrix, const double* const emissionMatrix, const double* const stateProb){
+
+	const int N = model->N;
+	const int states = model->states;
+	const int observables = model->observables;
+
+	for(int s = 0; s < states; s++){
+		memcpy(model->a + s*N, transitionMatrix + s*states, states * sizeof(double));
+		model->p[s] = stateProb[s];
+
+		for(int v = 0; v < observables; v++){
+			model->b[v*N + s] = emissionMatrix[s*observables + v];
+		}
+	}
+}
+
+void bw_model_get(const bw_model* const model, double* const transitionMatrix, double* const emissionMatrix, double* const stateProb){
+
+	const int N = model->N;
+	const int states = model->states;
+	const int observables = model->observables;
+
+	for(int s = 0; s < states; s++){
+		memcpy(transitionMatrix + s*states, model->a + s*N, states * sizeof(double));
+		stateProb[s] = model->p[s];
+
+		for(int v = 0; v < observables; v++){
+			emissionMatrix[s*observables + v] = model->b[v*N + s];
+		}
+	}
+}
+
+//the update divides the zero sums of the padding states by zero, put their rows back to zero
+static void clear_padding(double* const a, double* const b, double* const p, const int states, const int N, const int K){
+
+	for(int s = states; s < N; s++){
+		p[s] = 0.0;
+
+		for(int j = 0; j < N; j++){
+			a[s*N + j] = 0.0;
+		}
+
+		for(int v = 0; v < K; v++){
+			b[v*N + s] = 0.0;
+		}
+	}
+}
+
+static int valid_observations(const bw_model* const model, const int* const y, const int T){
+
+	if(model == NULL || y == NULL || T < 1){
+		return 0;
+	}
+
+	for(int t = 0; t < T; t++){
+		if(y[t] < 0 || y[t] >= model->observables){
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+//segments of the checkpointed forward step, about sqrt(T) long
+static int segment_length(const int T){
+	return (int) ceil(sqrt((double) T));
+}
+
+//CSR of the nonzeros of the model and of its transpose, -1 if the memory runs out
+static int workspace_sparse(workspace* const ws, const bw_model* const model){
+
+	const int N = model->N;
+	int nnz = 0;
+
+	for(int i = 0; i < N*N; i++){
+		nnz += model->a[i] != 0.0;
+	}
+
+	ws->nnz = nnz;
+	ws->row = (int*) malloc((N+1) * sizeof(int));
+	ws->col = (int*) malloc(nnz * sizeof(int));
+	ws->val = (double*) malloc(nnz * sizeof(double));
+	ws->trow = (int*) calloc(N+1, sizeof(int));
+	ws->tcol = (int*) malloc(nnz * sizeof(int));
+	ws->tpos = (int*) malloc(nnz * sizeof(int));
+	ws->tval = (double*) malloc(nnz * sizeof(double));
+
+	//malloc(0) may return NULL for a model without transitions
+	if(ws->row == NULL || ws->trow == NULL || (nnz > 0 && (ws->col == NULL || ws->val == NULL || ws->tcol == NULL || ws->tpos == NULL || ws->tval == NULL))){
+		return -1;
+	}
+
+	int k = 0;
+
+	for(int s = 0; s < N; s++){
+		ws->row[s] = k;
+
+		for(int j = 0; j < N; j++){
+			if(model->a[s*N + j] != 0.0){
+				ws->col[k] = j;
+				ws->val[k] = model->a[s*N + j];
+				ws->trow[j+1]++;
+				k++;
+			}
+		}
+	}
+
+	ws->row[N] = k;
+
+	//counting sort by column, the rows of the transposed stay sorted
+	for(int j = 0; j < N; j++){
+		ws->trow[j+1] += ws->trow[j];
+	}
+
+	int* fill = (int*) malloc(N * sizeof(int));
+
+	if(fill == NULL){
+		return -1;
+	}
+
+	memcpy(fill, ws->trow, N * sizeof(int));
+
+	for(int s = 0; s < N; s++){
+		for(int i = ws->row[s]; i < ws->row[s+1]; i++){
+			const int place = fill[ws->col[i]]++;
+			ws->tcol[place] = s;
+			ws->tpos[i] = place;
+		}
+	}
+
+	free(fill);
+
+	return 0;
+}
+
+//diagonals of the band that holds all nonzeros of the model, -1 if the memory runs out
+static int workspace_band(workspace* const ws, const bw_model* const model){
+
+	const int N = model->N;
+	int lower = 0;
+	int upper = 0;
+
+	for(int s = 0; s < N; s++){
+		for(int j = 0; j < N; j++){
+			if(model->a[s*N + j] != 0.0){
+				lower = s - j > lower ? s - j : lower;
+				upper = j - s > upper ? j - s : upper;
+			}
+		}
+	}
+
+	ws->lower = lower;
+	ws->upper = upper;
+	ws->diag = (double*) _mm_malloc((lower + upper + 1) * N * sizeof(double),ALIGNMENT);
+
+	if(ws->diag == NULL){
+		return -1;
+	}
+
+	for(int k = -lower; k <= upper; k++){
+		for(int s = 0; s < N; s++){
+			ws->diag[(k+lower)*N + s] = s + k >= 0 && s + k < N ? model->a[s*N + s+k] : 0.0;
+		}
+	}
+
+	return 0;
+}
+
+//observables that occur in the sequences, slot[v] is the row of v in the table of the present ones or -1
+static int present_observables(const bw_model* const model, const int* const* const y, const int* const T, const int sequences, int* const slot){
+
+	int present = 0;
+
+	for(int v = 0; v < model->K; v++){
+		slot[v] = -1;
+	}
+
+	for(int i = 0; i < sequences; i++){
+		for(int t = 0; t < T[i]; t++){
+			if(slot[y[i][t]] < 0){
+				slot[y[i][t]] = 0;
+				present++;
+			}
+		}
+	}
+
+	//rows in the order of the observables
+	int row = 0;
+
+	for(int v = 0; v < model->K; v++){
+		if(slot[v] == 0){
+			slot[v] = row++;
+		}
+	}
+
+	return present;
+}
+
+//BW_AB_AUTO: the full table if it fits into half of the L2 cache, else the table of the present observables
+//if that fits, else no table if the mode has kernels for it (full and present are sizes in doubles)
+static int choose_ab(const int requested, const int on_the_fly, const long full, const long present){
+
+	if(requested == BW_AB_FULL || requested == BW_AB_PRESENT){
+		return requested;
+	}
+
+	if(requested == BW_AB_ON_THE_FLY){
+		return on_the_fly ? BW_AB_ON_THE_FLY : BW_AB_PRESENT;
+	}
+
+	long budget = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	budget = (budget > 0 ? budget : 1048576) / 2 / sizeof(double);
+
+	const int smaller = present < full;
+
+	if(full <= budget){
+		return BW_AB_FULL;
+	}
+
+	if(smaller && present <= budget){
+		return BW_AB_PRESENT;
+	}
+
+	if(on_the_fly){
+		return BW_AB_ON_THE_FLY;
+	}
+
+	return smaller ? BW_AB_PRESENT : BW_AB_FULL;
+}
+
+//sequences and b in the rows of the present observables, -1 if the memory runs out
+static int workspace_present(workspace* const ws, const bw_model* const model, const int* const* const y, const int* const T, const int sequences, const long totalT, const int* const slot){
+
+	const int N = model->N;
+
+	ws->b = (double*) _mm_malloc(ws->K * N * sizeof(double),ALIGNMENT);
+	ws->symbols = (int*) malloc(ws->present * sizeof(int));
+	ws->yc = (int*) malloc(totalT * sizeof(int));
+	ws->ys = (const int**) malloc(sequences * sizeof(int*));
+
+	if(ws->b == NULL || ws->symbols == NULL || ws->yc == NULL || ws->ys == NULL){
+		return -1;
+	}
+
+	memset(ws->b, 0, ws->K * N * sizeof(double));
+
+	for(int v = 0; v < model->K; v++){
+		if(slot[v] >= 0){
+			ws->symbols[slot[v]] = v;
+		}
+	}
+
+	int* yc = ws->yc;
+
+	for(int i = 0; i < sequences; i++){
+		for(int t = 0; t < T[i]; t++){
+			yc[t] = slot[y[i][t]];
+		}
+
+		ws->ys[i] = yc;
+		yc += T[i];
+	}
+
+	ws->y = ws->ys;
+
+	return 0;
+}
+
+//buffers of a workspace, also the ones of a partial allocation (workspace_alloc starts from NULL)
+static void workspace_release(workspace* const ws){
+
+	for(int w = 0; ws->workers != NULL && w < ws->threads; w++){
+		worker* const wk = ws->workers + w;
+		_mm_free(wk->alpha);
+		_mm_free(wk->alpha_mixed);
+		_mm_free(wk->checkpoints);
+		_mm_free(wk->beta);
+		_mm_free(wk->beta_new);
+		_mm_free(wk->gamma0);
+		_mm_free(wk->ct);
+		_mm_free(wk->p_new);
+		_mm_free(wk->gamma_sum);
+		_mm_free(wk->gamma_T);
+		_mm_free(wk->a_new);
+		_mm_free(wk->b_new);
+		_mm_free(wk->w);
+	}
+
+	_mm_free(ws->at);
+	_mm_free(ws->ab);
+	_mm_free(ws->lb);
+	_mm_free(ws->lp);
+
+	if(ws->ab_mode == BW_AB_PRESENT){
+		_mm_free(ws->b);
+		free(ws->symbols);
+		free(ws->yc);
+		free(ws->ys);
+	}
+
+	if(ws->banded){
+		_mm_free(ws->diag);
+	}
+
+	if(ws->sparse){
+		free(ws->row);
+		free(ws->col);
+		free(ws->val);
+		free(ws->trow);
+		free(ws->tcol);
+		free(ws->tpos);
+		free(ws->tval);
+	}
+
+	_mm_free(ws->products);
+	_mm_free(ws->scratch);
+	_mm_free(ws->starts);
+	free(ws->workers);
+}
+
+//split the sequences into contiguous blocks of about the same total length
+//the split only depends on the lengths, so the results are reproducible
+//splitting in time all sequences go to worker 0
+//returns -1 if the memory runs out, nothing stays allocated then
+static int workspace_alloc(workspace* const ws, bw_model* const model, const int* const* const y, const int* const T, const int sequences, const long totalT, const int threads, const int time_parallel, const int checkpoint, const int mixed, const int log_space, const int sparse, const int banded, const int xi_block, const int ab){
+
+	const int N = model->N;
+
+	//all buffers NULL, so that workspace_release can undo a partial allocation
+	memset(ws, 0, sizeof(workspace));
+	ws->model = model;
+	ws->y = y;
+	ws->T = T;
+	ws->threads = threads;
+	ws->time_parallel = time_parallel;
+	ws->checkpoint = checkpoint;
+	ws->mixed = mixed;
+	ws->xi_block = xi_block;
+	ws->log_space = log_space;
+	ws->sparse = sparse;
+	ws->banded = banded;
+	ws->b = model->b;
+	ws->K = model->K;
+
+	if(banded){
+		if(workspace_band(ws, model) < 0){
+			workspace_release(ws);
+			return -1;
+		}
+
+		ws->a_size = (ws->lower + ws->upper + 1) * N;
+	}else if(sparse){
+		if(workspace_sparse(ws, model) < 0){
+			workspace_release(ws);
+			return -1;
+		}
+
+		ws->a_size = padded(ws->nnz);
+	}else{
+		ws->a_size = N * N;
+	}
+
+	//doubles of ab per observable, only the scaled double precision kernels can do without ab
+	const long ab_size = sparse ? ws->nnz : ws->a_size;
+	const int on_the_fly = !banded && !sparse && !log_space && !mixed && !time_parallel;
+	int* slot = (int*) malloc(model->K * sizeof(int));
+
+	if(slot == NULL){
+		workspace_release(ws);
+		return -1;
+	}
+
+	ws->present = present_observables(model, y, T, sequences, slot);
+	ws->ab_mode = choose_ab(xi_block ? BW_AB_ON_THE_FLY : ab, on_the_fly, model->K * ab_size, padded(ws->present) * ab_size);
+
+	if(ws->ab_mode == BW_AB_PRESENT){
+		ws->K = padded(ws->present);
+
+		if(workspace_present(ws, model, y, T, sequences, totalT, slot) < 0){
+			free(slot);
+			workspace_release(ws);
+			return -1;
+		}
+	}
+
+	free(slot);
+
+	const int K = ws->K;
+
+	ws->at = banded || sparse ? NULL : (double*) _mm_malloc(N * N * sizeof(double),ALIGNMENT);
+	ws->ab = ws->ab_mode == BW_AB_ON_THE_FLY ? NULL : (double*) _mm_malloc(K * ab_size * sizeof(double),ALIGNMENT);
+	ws->lb = log_space ? (double*) _mm_malloc(K * N * sizeof(double),ALIGNMENT) : NULL;
+	ws->lp = log_space ? (double*) _mm_malloc(N * sizeof(double),ALIGNMENT) : NULL;
+	ws->workers = (worker*) calloc(threads, sizeof(worker));
+
+	//an empty ab (a model without transitions) may come back as NULL
+	if((!banded && !sparse && ws->at == NULL) || (ws->ab_mode != BW_AB_ON_THE_FLY && ab_size > 0 && ws->ab == NULL)
+		|| (log_space && (ws->lb == NULL || ws->lp == NULL)) || ws->workers == NULL){
+		workspace_release(ws);
+		return -1;
+	}
+
+	const int blocks = time_parallel ? 1 : threads;
+	long done = 0;
+	int i = 0;
+
+	for(int w = 0; w < threads; w++){
+		worker* const wk = ws->workers + w;
+		const long target = totalT * (w + 1) / blocks;
+		int maxT = 1;
+
+		//leave at least one sequence for each remaining worker,
+		//split in time the others only help worker 0 and get no sequences (first == last)
+		wk->first = i;
+		while(w < blocks && i < sequences - (blocks - w - 1) && (i == wk->first || done + T[i] <= target)){
+			maxT = maxT < T[i] ? T[i] : maxT;
+			done += T[i];
+			i++;
+		}
+		wk->last = w == blocks - 1 ? sequences : i;
+
+		for(int j = i; j < wk->last; j++){
+			maxT = maxT < T[j] ? T[j] : maxT;
+		}
+
+		//at most segment_length(maxT) + 1 segments of at most segment_length(maxT) steps
+		const int alphaT = checkpoint ? segment_length(maxT) + 1 : mixed ? 1 : maxT;
+		const int owns = wk->first < wk->last;
+
+		//only workers with sequences keep alpha and ct of a whole sequence
+		wk->alpha_mixed = owns && mixed ? (float*) _mm_malloc((size_t)N * maxT * sizeof(float),ALIGNMENT) : NULL;
+		wk->alpha = owns ? (double*) _mm_malloc((size_t)N * alphaT * sizeof(double),ALIGNMENT) : NULL;
+		wk->checkpoints = owns && checkpoint ? (double*) _mm_malloc((size_t)N * alphaT * sizeof(double),ALIGNMENT) : NULL;
+		wk->beta = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+		wk->beta_new = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+		wk->gamma0 = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+		wk->ct = owns ? (double*) _mm_malloc(maxT * sizeof(double),ALIGNMENT) : NULL;
+		wk->p_new = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+		wk->gamma_sum = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+		wk->gamma_T = (double*) _mm_malloc(N * sizeof(double),ALIGNMENT);
+		wk->a_new = (double*) _mm_malloc(ws->a_size * sizeof(double),ALIGNMENT);
+		wk->b_new = (double*) _mm_malloc(K * N * sizeof(double),ALIGNMENT);
+		wk->w = xi_block ? (double*) _mm_malloc(xi_block * N * sizeof(double),ALIGNMENT) : NULL;
+
+		if((owns && (wk->alpha == NULL || wk->ct == NULL)) || (owns && mixed && wk->alpha_mixed == NULL) || (owns && checkpoint && wk->checkpoints == NULL)
+			|| wk->beta == NULL || wk->beta_new == NULL || wk->gamma0 == NULL || wk->p_new == NULL || wk->gamma_sum == NULL || wk->gamma_T == NULL
+			|| (ws->a_size > 0 && wk->a_new == NULL) || wk->b_new == NULL || (xi_block && wk->w == NULL)){
+			workspace_release(ws);
+			return -1;
+		}
+	}
+
+	if(time_parallel){
+		ws->products = (double*) _mm_malloc(threads * N * N * sizeof(double),ALIGNMENT);
+		ws->scratch = (double*) _mm_malloc(threads * N * N * sizeof(double),ALIGNMENT);
+		ws->starts = (double*) _mm_malloc(threads * N * sizeof(double),ALIGNMENT);
+
+		if(ws->products == NULL || ws->scratch == NULL || ws->starts == NULL){
+			workspace_release(ws);
+			return -1;
+		}
+	}
+
+	if(threads > 1){
+		pthread_barrier_init(&ws->barrier, NULL, threads);
+	}
+
+	return 0;
+}
+
+static void workspace_free(workspace* const ws){
+
+	if(ws->threads > 1){
+		pthread_barrier_destroy(&ws->barrier);
+	}
+
+	workspace_release(ws);
+}
+
+static void worker_reset(worker* const wk, const int N, const int K, const int a_size){
+	engine->zero(wk->p_new, 1, N);
+	engine->zero(wk->gamma_sum, 1, N);
+	engine->zero(wk->gamma_T, 1, N);
+	engine->zero(wk->a_new, 1, a_size);
+	engine->zero(wk->b_new, K, N);
+	wk->logLikelihood = 0.0;
+}
+
+//alpha of segment k (steps k*L...min((k+1)*L, T)-1) from the checkpoint of segment k-1
+static void forward_segment(const workspace* const ws, worker* const wk, const int* const y, const int k, const int L, const int T){
+
+	const bw_model* const model = ws->model;
+	const int N = model->N;
+	const int first = k*L;
+	const int last = first + L < T ? first + L : T;
+
+	if(k == 0){
+		engine->forward(ws->at, ws->b, model->p, y, wk->alpha, wk->ct, N, last);
+	}else{
+		engine->forward_steps(ws->at, ws->b, y, wk->checkpoints + (size_t)(k-1)*N, wk->alpha, wk->ct, N, first, last);
+	}
+}
+
+//forward step keeping only the last alpha of each segment,
+//the fused backward and update step recomputes the segments from the back
+static void checkpointed_forward_backward(const workspace* const ws, worker* const wk, const int* const y, const int T){
+
+	const int N = ws->model->N;
+	const int L = segment_length(T);
+	const int segments = (T + L - 1) / L;
+
+	//FORWARD
+	for(int k = 0; k < segments; k++){
+		const int last = (k+1)*L < T ? (k+1)*L : T;
+		forward_segment(ws, wk, y, k, L, T);
+		memcpy(wk->checkpoints + (size_t)k*N, wk->alpha + (size_t)(last-1-k*L)*N, N * sizeof(double));
+	}
+
+	//FUSED BACKWARD and UPDATE STEP
+	engine->backward_init(wk->checkpoints + (size_t)(segments-1)*N, wk->ct, y, wk->beta, wk->gamma0, wk->gamma_T, wk->b_new, N, T);
+
+	for(int k = segments-1; k >= 0; k--){
+		const int first = k*L;
+		const int last = (k+1)*L < T-1 ? (k+1)*L : T-1;
+
+		if(first < last){
+			//the last segment is still there from the forward step
+			if(k < segments-1){
+				forward_segment(ws, wk, y, k, L, T);
+			}
+
+			if(ws->ab_mode == BW_AB_ON_THE_FLY){
+				engine->backward_steps_otf(ws->model->a, ws->b, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->gamma_sum, wk->a_new, wk->b_new, N, first, last);
+			}else{
+				engine->backward_steps(ws->ab, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->gamma_sum, wk->a_new, wk->b_new, N, first, last);
+			}
+		}
+	}
+
+	engine->add(wk->p_new, wk->gamma0, 1, N);
+}
+
+//forward step and fused backward and update step on the sequences of one worker
+//followed by a tree reduction of the sums into worker 0 (always in the same order)
+static void* expectation_worker(void* const arg){
+
+	workspace* const ws = ((worker_arg*) arg)->ws;
+	const int id = ((worker_arg*) arg)->id;
+	worker* const wk = ws->workers + id;
+	const bw_model* const model = ws->model;
+	const int N = model->N;
+	const int K = ws->K;
+
+	worker_reset(wk, N, K, ws->a_size);
+
+	for(int i = wk->first; i < wk->last; i++){
+		const int* const y = ws->y[i];
+		const int T = ws->T[i];
+
+		if(ws->banded){
+			band_forward(ws->diag, ws->b, model->p, y, wk->alpha, wk->ct, ws->lower, ws->upper, N, T);
+			band_backward(ws->ab, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, ws->lower, ws->upper, N, T);
+			wk->logLikelihood += engine->log_likelihood(wk->ct, T);
+			continue;
+		}
+
+		if(ws->sparse){
+			csr_forward(ws->trow, ws->tcol, ws->tval, ws->b, model->p, y, wk->alpha, wk->ct, N, T);
+			csr_backward(ws->row, ws->col, ws->ab, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, ws->nnz, N, T);
+			wk->logLikelihood += engine->log_likelihood(wk->ct, T);
+			continue;
+		}
+
+		if(ws->checkpoint){
+			checkpointed_forward_backward(ws, wk, y, T);
+			wk->logLikelihood += engine->log_likelihood(wk->ct, T);
+			continue;
+		}
+
+		if(ws->log_space){
+			const double lnP = engine->log_forward(ws->at, ws->lb, ws->lp, y, wk->alpha, N, T);
+			engine->log_backward(ws->ab, wk->alpha, lnP, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, N, T);
+			wk->logLikelihood += lnP / M_LN2;
+			continue;
+		}
+
+		if(ws->mixed){
+			engine->mix_forward(ws->at, ws->b, model->p, y, wk->alpha_mixed, wk->ct, wk->alpha, N, T);
+			engine->mix_backward(ws->ab, wk->alpha_mixed, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, N, T);
+			wk->logLikelihood += engine->log_likelihood(wk->ct, T);
+			continue;
+		}
+
+		//FORWARD
+		engine->forward(ws->at, ws->b, model->p, y, wk->alpha, wk->ct, N, T);
+
+		//FUSED BACKWARD and UPDATE STEP
+		if(ws->xi_block){
+			engine->backward_blocked(model->a, ws->b, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, wk->w, N, T, ws->xi_block);
+		}else if(ws->ab_mode == BW_AB_ON_THE_FLY){
+			engine->backward_init(wk->alpha + (size_t)(T-1)*N, wk->ct, y, wk->beta, wk->gamma0, wk->gamma_T, wk->b_new, N, T);
+			engine->backward_steps_otf(model->a, ws->b, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->gamma_sum, wk->a_new, wk->b_new, N, 0, T-1);
+			engine->add(wk->p_new, wk->gamma0, 1, N);
+		}else{
+			engine->backward(ws->ab, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, N, T);
+		}
+
+		wk->logLikelihood += engine->log_likelihood(wk->ct, T);
+	}
+
+	for(int stride = 1; stride < ws->threads; stride*=2){
+		pthread_barrier_wait(&ws->barrier);
+
+		if(id % (2*stride) == 0 && id + stride < ws->threads){
+			const worker* const other = ws->workers + id + stride;
+			engine->add(wk->p_new, other->p_new, 1, N);
+			engine->add(wk->gamma_sum, other->gamma_sum, 1, N);
+			engine->add(wk->gamma_T, other->gamma_T, 1, N);
+			engine->add(wk->a_new, other->a_new, 1, ws->a_size);
+			engine->add(wk->b_new, other->b_new, K, N);
+			wk->logLikelihood += other->logLikelihood;
+		}
+	}
+
+	return NULL;
+}
+
+//expectation step with the forward step of each sequence split into one chunk per thread:
+//1. worker 0 runs the forward step on chunk 0, the others build the product of ab over their chunk
+//2. worker 0 stitches the chunks together, getting the alpha in front of each chunk
+//3. the others run the forward step on their chunk starting from that alpha
+//the fused backward and update step stays serial on worker 0
+static void* time_parallel_worker(void* const arg){
+
+	workspace* const ws = ((worker_arg*) arg)->ws;
+	const int id = ((worker_arg*) arg)->id;
+	worker* const wk = ws->workers;
+	const bw_model* const model = ws->model;
+	const int N = model->N;
+	const int K = ws->K;
+
+	if(id == 0){
+		worker_reset(wk, N, K, ws->a_size);
+	}
+
+	for(int i = wk->first; i < wk->last; i++){
+		const int* const y = ws->y[i];
+		const int T = ws->T[i];
+		const int chunks = ws->threads < T ? ws->threads : T;
+		const int first = id * T / chunks;
+		const int last = (id + 1) * T / chunks;
+
+		//FORWARD of chunk 0 and PRODUCTS of the other chunks
+		if(id == 0){
+			engine->forward(ws->at, ws->b, model->p, y, wk->alpha, wk->ct, N, last);
+		}else if(id < chunks){
+			engine->chunk_product(ws->ab, y, ws->products + id*N*N, ws->scratch + id*N*N, N, first, last);
+		}
+
+		pthread_barrier_wait(&ws->barrier);
+
+		//STITCHING
+		if(id == 0){
+			memcpy(ws->starts + N, wk->alpha + (size_t)(last-1)*N, N * sizeof(double));
+
+			for(int c = 2; c < chunks; c++){
+				engine->stitch(ws->starts + (c-1)*N, ws->products + (c-1)*N*N, ws->starts + c*N, N);
+			}
+		}
+
+		pthread_barrier_wait(&ws->barrier);
+
+		//FORWARD of the other chunks
+		if(id > 0 && id < chunks){
+			engine->forward_steps(ws->at, ws->b, y, ws->starts + id*N, wk->alpha + (size_t)first*N, wk->ct, N, first, last);
+		}
+
+		pthread_barrier_wait(&ws->barrier);
+
+		//FUSED BACKWARD and UPDATE STEP
+		if(id == 0){
+			engine->backward(ws->ab, wk->alpha, wk->ct, y, wk->beta, wk->beta_new, wk->gamma0, wk->p_new, wk->gamma_sum, wk->gamma_T, wk->a_new, wk->b_new, N, T);
+
+			wk->logLikelihood += engine->log_likelihood(wk->ct, T);
+		}
+	}
+
+	return NULL;
+}
+
+//expectation step on all sequences, the sums of xi and gamma are pooled in worker 0
+//returns the total log-likelihood
+static double expectation(workspace* const ws){
+
+	const bw_model* const model = ws->model;
+	const int N = model->N;
+	const int K = ws->K;
+
+	if(ws->ab_mode == BW_AB_PRESENT){
+		for(int i = 0; i < ws->present; i++){
+			memcpy(ws->b + i*N, model->b + ws->symbols[i]*N, N * sizeof(double));
+		}
+	}
+
+	//forward runs on the transposed, the backward step on the precomputed a*b
+	if(ws->banded){
+		band_build(ws->diag, ws->b, ws->ab, ws->lower, ws->upper, N, K);
+	}else if(ws->sparse){
+		csr_build(ws->val, ws->col, ws->tpos, ws->b, ws->tval, ws->ab, ws->nnz, N, K);
+	}else{
+		memcpy(ws->at, model->a, N * N * sizeof(double));
+		engine->transpose(ws->at, N);
+
+		if(ws->ab_mode != BW_AB_ON_THE_FLY){
+			engine->build_ab(model->a, ws->b, ws->ab, N, K);
+		}
+	}
+
+	if(ws->log_space){
+		memcpy(ws->lb, ws->b, K * N * sizeof(double));
+		memcpy(ws->lp, model->p, N * sizeof(double));
+		engine->logarithm(ws->at, N, N);
+		engine->logarithm(ws->ab, K*N, N);
+		engine->logarithm(ws->lb, K, N);
+		engine->logarithm(ws->lp, 1, N);
+	}
+
+	pthread_t threads[ws->threads];
+	worker_arg args[ws->threads];
+
+	for(int w = 0; w < ws->threads; w++){
+		args[w].ws = ws;
+		args[w].id = w;
+	}
+
+	for(int w = 1; w < ws->threads; w++){
+		pthread_create(threads + w, NULL, ws->time_parallel ? time_parallel_worker : expectation_worker, args + w);
+	}
+
+	if(ws->time_parallel){
+		time_parallel_worker(args);
+	}else{
+		expectation_worker(args);
+	}
+
+	for(int w = 1; w < ws->threads; w++){
+		pthread_join(threads[w], NULL);
+	}
+
+	return ws->workers[0].logLikelihood;
+}
+
+static void maximization(workspace* const ws, const int sequences){
+	bw_model* const model = ws->model;
+	const worker* const sums = ws->workers;
+
+	if(ws->banded){
+		band_update(ws->diag, ws->b, model->p, sums->gamma_sum, sums->gamma_T, sums->p_new, sums->a_new, sums->b_new, sequences, ws->lower, ws->upper, model->N, ws->K);
+
+		//the band of the padding states, like clear_padding
+		for(int k = -ws->lower; k <= ws->upper; k++){
+			for(int s = model->states; s < model->N; s++){
+				ws->diag[(k+ws->lower)*model->N + s] = 0.0;
+			}
+		}
+	}else if(ws->sparse){
+		csr_update(ws->val, ws->row, ws->b, model->p, sums->gamma_sum, sums->gamma_T, sums->p_new, sums->a_new, sums->b_new, sequences, model->N, ws->K);
+	}else{
+		//the blocked backward step leaves out the factor a(s,j) that all time steps share
+		if(ws->xi_block){
+			for(int i = 0; i < model->N * model->N; i++){
+				sums->a_new[i] *= model->a[i];
+			}
+		}
+
+		engine->update(model->a, ws->b, model->p, sums->gamma_sum, sums->gamma_T, sums->p_new, sums->a_new, sums->b_new, sequences, model->N, ws->K);
+	}
+
+	//back into the rows of their observables, the others never occur and get zero like in the full table
+	if(ws->ab_mode == BW_AB_PRESENT){
+		memset(model->b, 0, model->K * model->N * sizeof(double));
+
+		for(int i = 0; i < ws->present; i++){
+			memcpy(model->b + ws->symbols[i]*model->N, ws->b + i*model->N, model->N * sizeof(double));
+		}
+	}
+
+	clear_padding(model->a, model->b, model->p, model->states, model->N, model->K);
+}
+
+static double initial_step(workspace* const ws){
+	return expectation(ws);
+}
+
+static double baum_welch(workspace* const ws, const int sequences){
+	maximization(ws, sequences);
+	return expectation(ws);
+}
+
+static void final_scaling(workspace* const ws, const int sequences){
+
+	maximization(ws, sequences);
+
+	const bw_model* const model = ws->model;
+
+	//the zeros of a are still zero in the model
+	if(ws->banded){
+		for(int k = -ws->lower; k <= ws->upper; k++){
+			for(int s = 0; s < model->N; s++){
+				if(s + k >= 0 && s + k < model->N){
+					model->a[s*model->N + s+k] = ws->diag[(k+ws->lower)*model->N + s];
+				}
+			}
+		}
+	}
+
+	if(ws->sparse){
+		for(int s = 0; s < model->N; s++){
+			for(int k = ws->row[s]; k < ws->row[s+1]; k++){
+				model->a[s*model->N + ws->col[k]] = ws->val[k];
+			}
+		}
+	}
+}
+
+//buffers of one training run in single precision, the model is copied in and out
+typedef struct {
+	float* a;
+	float* at;
+	float* b;
+	float* p;
+	float* ab;
+	float* alpha;
+	float* beta;
+	float* beta_new;
+	float* gamma0;
+	float* ct;
+	float* p_new;
+	float* gamma_sum;
+	float* gamma_T;
+	float* a_new;
+	float* b_new;
+	int N;		//padded to a multiple of 8 for the 8 float registers
+	int K;
+	int states;
+	const int* const* y;
+	const int* T;
+	int sequences;
+} flt_workspace;
+
+static void flt_workspace_release(flt_workspace* const ws){
+	_mm_free(ws->a);
+	_mm_free(ws->at);
+	_mm_free(ws->b);
+	_mm_free(ws->p);
+	_mm_free(ws->ab);
+	_mm_free(ws->alpha);
+	_mm_free(ws->beta);
+	_mm_free(ws->beta_new);
+	_mm_free(ws->gamma0);
+	_mm_free(ws->ct);
+	_mm_free(ws->p_new);
+	_mm_free(ws->gamma_sum);
+	_mm_free(ws->gamma_T);
+	_mm_free(ws->a_new);
+	_mm_free(ws->b_new);
+}
+
+//-1 if the memory runs out, nothing stays allocated then
+static int flt_workspace_alloc(flt_workspace* const ws, const bw_model* const model, const int* const* const y, const int* const T, const int sequences){
+
+	const int N = (model->N + 7) & ~7;
+	const int K = model->K;
+	int maxT = 1;
+
+	for(int i = 0; i < sequences; i++){
+		maxT = maxT < T[i] ? T[i] : maxT;
+	}
+
+	ws->N = N;
+	ws->K = K;
+	ws->states = model->states;
+	ws->y = y;
+	ws->T = T;
+	ws->sequences = sequences;
+	ws->a = (float*) _mm_malloc(N * N * sizeof(float),ALIGNMENT);
+	ws->at = (float*) _mm_malloc(N * N * sizeof(float),ALIGNMENT);
+	ws->b = (float*) _mm_malloc(K * N * sizeof(float),ALIGNMENT);
+	ws->p = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->ab = (float*) _mm_malloc((size_t)N * N * K * sizeof(float),ALIGNMENT);
+	ws->alpha = (float*) _mm_malloc((size_t)N * maxT * sizeof(float),ALIGNMENT);
+	ws->beta = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->beta_new = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->gamma0 = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->ct = (float*) _mm_malloc(maxT * sizeof(float),ALIGNMENT);
+	ws->p_new = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->gamma_sum = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->gamma_T = (float*) _mm_malloc(N * sizeof(float),ALIGNMENT);
+	ws->a_new = (float*) _mm_malloc(N * N * sizeof(float),ALIGNMENT);
+	ws->b_new = (float*) _mm_malloc(K * N * sizeof(float),ALIGNMENT);
+
+	if(ws->a == NULL || ws->at == NULL || ws->b == NULL || ws->p == NULL || ws->ab == NULL || ws->alpha == NULL || ws->beta == NULL || ws->beta_new == NULL
+		|| ws->gamma0 == NULL || ws->ct == NULL || ws->p_new == NULL || ws->gamma_sum == NULL || ws->gamma_T == NULL || ws->a_new == NULL || ws->b_new == NULL){
+		flt_workspace_release(ws);
+		return -1;
+	}
+
+	flt_zero(ws->a, N, N);
+	flt_zero(ws->b, K, N);
+	flt_zero(ws->p, 1, N);
+
+	for(int s = 0; s < model->N; s++){
+		for(int j = 0; j < model->N; j++){
+			ws->a[s*N + j] = (float) model->a[s*model->N + j];
+		}
+
+		for(int v = 0; v < K; v++){
+			ws->b[v*N + s] = (float) model->b[v*model->N + s];
+		}
+
+		ws->p[s] = (float) model->p[s];
+	}
+
+	return 0;
+}
+
+static void flt_workspace_free(flt_workspace* const ws, bw_model* const model){
+
+	const int N = ws->N;
+	const int K = ws->K;
+
+	for(int s = 0; s < model->N; s++){
+		for(int j = 0; j < model->N; j++){
+			model->a[s*model->N + j] = ws->a[s*N + j];
+		}
+
+		for(int v = 0; v < K; v++){
+			model->b[v*model->N + s] = ws->b[v*N + s];
+		}
+
+		model->p[s] = ws->p[s];
+	}
+
+	flt_workspace_release(ws);
+}
+
+static double flt_expectation(flt_workspace* const ws){
+
+	const int N = ws->N;
+	const int K = ws->K;
+	double logLikelihood = 0.0;
+
+	flt_zero(ws->p_new, 1, N);
+	flt_zero(ws->gamma_sum, 1, N);
+	flt_zero(ws->gamma_T, 1, N);
+	flt_zero(ws->a_new, N, N);
+	flt_zero(ws->b_new, K, N);
+
+	memcpy(ws->at, ws->a, N * N * sizeof(float));
+	flt_transpose(ws->at, N);
+	flt_build_ab(ws->a, ws->b, ws->ab, N, K);
+
+	for(int i = 0; i < ws->sequences; i++){
+		const int* const y = ws->y[i];
+		const int T = ws->T[i];
+
+		//FORWARD
+		flt_forward(ws->at, ws->b, ws->p, y, ws->alpha, ws->ct, N, T);
+
+		//FUSED BACKWARD and UPDATE STEP
+		flt_backward(ws->ab, ws->alpha, ws->ct, y, ws->beta, ws->beta_new, ws->gamma0, ws->p_new, ws->gamma_sum, ws->gamma_T, ws->a_new, ws->b_new, N, T);
+
+		logLikelihood += flt_log_likelihood(ws->ct, T);
+	}
+
+	return logLikelihood;
+}
+
+static void flt_maximization(flt_workspace* const ws){
+
+	const int N = ws->N;
+	const int K = ws->K;
+
+	flt_update(ws->a, ws->b, ws->p, ws->gamma_sum, ws->gamma_T, ws->p_new, ws->a_new, ws->b_new, ws->sequences, N, K);
+
+	//same as clear_padding
+	for(int s = ws->states; s < N; s++){
+		ws->p[s] = 0.0f;
+
+		for(int j = 0; j < N; j++){
+			ws->a[s*N + j] = 0.0f;
+		}
+
+		for(int v = 0; v < K; v++){
+			ws->b[v*N + s] = 0.0f;
+		}
+	}
+}
+
+static double flt_initial_step(flt_workspace* const ws){
+	return flt_expectation(ws);
+}
+
+static double flt_baum_welch(flt_workspace* const ws){
+	flt_maximization(ws);
+	return flt_expectation(ws);
+}
+
+static void flt_final_scaling(flt_workspace* const ws){
+	flt_maximization(ws);
+}
+
+//same iteration as below in single precision
+static int flt_train(bw_model* const model, const int* const* const y, const int* const T, const int sequences, const double epsilon, const int maxSteps){
+
+	flt_workspace ws;
+
+	if(flt_workspace_alloc(&ws, model, y, T, sequences) < 0){
+		return -1;
+	}
+
+	double logLikelihood = flt_initial_step(&ws);
+	double disparance = DBL_MAX;
+	int steps = 1;
+
+	while(disparance >= epsilon && steps < maxSteps){
+		double newLogLikelihood = flt_baum_welch(&ws);
+		steps+=1;
+
+		disparance = newLogLikelihood - logLikelihood;
+		logLikelihood = newLogLikelihood;
+	}
+
+	flt_final_scaling(&ws);
+
+	flt_workspace_free(&ws, model);
+
+	return steps;
+}
+
+int bw_train_multi(bw_model* const model, const int* const* const y, const int* const T, const int sequences, const bw_options* const options){
+
+	if(model == NULL || y == NULL || T == NULL || sequences < 1){
+		return -1;
+	}
+
+	select_engine();
+
+	long totalT = 0;
+
+	for(int i = 0; i < sequences; i++){
+		if(!valid_observations(model, y[i], T[i])){
+			return -1;
+		}
+
+		totalT += T[i];
+	}
+
+	bw_options defaults;
+
+	if(options == NULL){
+		bw_options_init(&defaults);
+	}
+
+	const bw_options* const opt = options == NULL ? &defaults : options;
+	const int N = model->states;
+	const int K = model->observables;
+
+	//same heuristic as in the harnesses and tested_implementation
+	int maxSteps = opt->max_steps;
+
+	if(maxSteps <= 0){
+		int minima = 10;
+		int variableSteps = 100-cbrt((double)N*K*totalT)/3;
+		maxSteps = minima < variableSteps ? variableSteps : minima;
+	}
+
+	//without AVX2 the band goes through the sparse kernels
+	const int banded = opt->banded && engine->simd;
+	const int sparse = (opt->sparse || opt->banded) && !banded;
+	const int log_space = opt->log_space && !sparse && !banded;
+	const int scaled = !log_space && !sparse && !banded;
+
+	//the float and mixed kernels need AVX2 and FMA
+	if(scaled && opt->precision != BW_DOUBLE && !engine->simd){
+		return -1;
+	}
+
+	if(scaled && opt->precision == BW_FLOAT){
+		const int steps = flt_train(model, y, T, sequences, opt->epsilon, maxSteps);
+		model->ab = steps > 0 ? BW_AB_FULL : model->ab;
+		return steps;
+	}
+
+	int threads = opt->threads;
+
+	if(threads <= 0){
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	const int mixed = opt->precision == BW_MIXED && scaled;
+	const int time_parallel = opt->time_parallel && threads > 1 && !mixed && scaled;
+	const int checkpoint = opt->checkpoint && !time_parallel && !mixed && scaled;
+	const int xi_block = opt->xi_block > 0 && !time_parallel && !checkpoint && !mixed && scaled ? opt->xi_block : 0;
+
+	if(!time_parallel){
+		threads = threads < sequences ? threads : sequences;
+	}
+
+	workspace ws;
+
+	if(workspace_alloc(&ws, model, y, T, sequences, totalT, threads, time_parallel, checkpoint, mixed, log_space, sparse, banded, xi_block, opt->ab) < 0){
+		return -1;
+	}
+
+	model->ab = ws.ab_mode;
+
+	double logLikelihood = initial_step(&ws);
+	double disparance = DBL_MAX;
+	int steps = 1;
+
+	while(disparance >= opt->epsilon && steps < maxSteps){
+		double newLogLikelihood = baum_welch(&ws, sequences);
+		steps+=1;
+
+		disparance = newLogLikelihood - logLikelihood;
+		logLikelihood = newLogLikelihood;
+	}
+
+	final_scaling(&ws, sequences);
+
+	workspace_free(&ws);
+
+	return steps;
+}
+
+int bw_train(bw_model* const model, const int* const y, const int T, const bw_options* const options){
+	return bw_train_multi(model, &y, &T, 1, options);
+}
+
+double bw_score(const bw_model* const model, const int* const y, const int T){
+
+	if(!valid_observations(model, y, T)){
+		return NAN;
+	}
+
+	select_engine();
+
+	const int N = model->N;
+
+	double* a = (double*) _mm_malloc(N * N * sizeof(double),ALIGNMENT);
+	double* alpha = (double*) _mm_malloc((size_t)N * T * sizeof(double),ALIGNMENT);
+	double* ct = (double*) _mm_malloc(T * sizeof(double),ALIGNMENT);
+
+	if(a == NULL || alpha == NULL || ct == NULL){
+		_mm_free(a);
+		_mm_free(alpha);
+		_mm_free(ct);
+		return NAN;
+	}
+
+	memcpy(a, model->a, N * N * sizeof(double));
+	engine->transpose(a, N);
+	engine->forward(a, model->b, model->p, y, alpha, ct, N, T);
+
+	double logLikelihood = engine->log_likelihood(ct, T);
+
+	_mm_free(a);
+	_mm_free(alpha);
+	_mm_free(ct);
+
+	return logLikelihood;
+}
@@ -8,17 +8,30 @@
 #include "io.h"
 #include "tested.h"
 #include "util.h"
+#include "bench.h"
 
 double EPSILON = 1e-4;
 #define DELTA 1e-2
 #define BUFSIZE 1<<26
 
-void initial_step(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
-
-	double* beta = (double*) malloc(T  * sizeof(double));
-	double* beta_new = (double*) malloc(T * sizeof(double));
-	double* alpha = (double*) malloc(N * T * sizeof(double));
-	double* ab = (double*) malloc(N * N * (T-1) * sizeof(double));
+//cycles and calls of the phases of train (only counted with -DPHASES)
+static phase phases[PHASE_COUNT];
+
+//the steps take all their buffers from ctx, nothing is allocated per iteration
+void initial_step(double* const a, double* const b, double* const p, const int* const y, context* const ctx){
+
+	const int N = ctx->N;
+	const int K = ctx->K;
+	const int T = ctx->T;
+	double* const gamma_sum = ctx->gamma_sum;
+	double* const gamma_T = ctx->gamma_T;
+	double* const a_new = ctx->a_new;
+	double* const b_new = ctx->b_new;
+	double* const ct = ctx->ct;
+	double* beta = ctx->beta;
+	double* beta_new = ctx->beta_new;
+	double* const alpha = ctx->alpha;
+	double* const ab = ctx->ab;
 
 	//FORWARD
 
@@ -164,20 +177,24 @@ void initial_step(double* const a, double* const b, double* const p, const int*
 		yt=yt1;
 	}
 
-	free(beta);
-	free(beta_new);
-	free(alpha);
-	free(ab);
 	return;
 
 }
 
-void baum_welch(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
-
-	double* beta = (double*) malloc(N  * sizeof(double));
-	double* beta_new = (double*) malloc(N * sizeof(double));
-	double* alpha = (double*) malloc(N * T * sizeof(double));
-	double* ab = (double*) malloc(N * N * K * sizeof(double));
+void baum_welch(double* const a, double* const b, double* const p, const int* const y, context* const ctx){
+
+	const int N = ctx->N;
+	const int K = ctx->K;
+	const int T = ctx->T;
+	double* const gamma_sum = ctx->gamma_sum;
+	double* const gamma_T = ctx->gamma_T;
+	double* const a_new = ctx->a_new;
+	double* const b_new = ctx->b_new;
+	double* const ct = ctx->ct;
+	double* beta = ctx->beta;
+	double* beta_new = ctx->beta_new;
+	double* const alpha = ctx->alpha;
+	double* const ab = ctx->ab;
 
 	int yt = y[T-1];
 
@@ -403,15 +420,19 @@ void baum_welch(double* const a, double* const b, double* const p, const int* co
 		yt=yt1;	
 	}
 
-	free(alpha);
-	free(beta);
-	free(beta_new);
-	free(ab);
 	
 	return;
 }
 
-void final_scaling(double* const a, double* const b, double* const p, const int* const y, double * const gamma_sum, double* const gamma_T,double* const a_new,double* const b_new, double* const ct, const int N, const int K, const int T){
+void final_scaling(double* const a, double* const b, double* const p, const int* const y, context* const ctx){
+
+	const int N = ctx->N;
+	const int K = ctx->K;
+	const int T = ctx->T;
+	double* const gamma_sum = ctx->gamma_sum;
+	double* const gamma_T = ctx->gamma_T;
+	double* const a_new = ctx->a_new;
+	double* const b_new = ctx->b_new;
 
 	//compute new transition matrix
 	for(int s = 0; s < N; s++){
@@ -442,545 +463,607 @@ void final_scaling(double* const a, double* const b, double* const p, const int*
 
 
 
-void heatup(double* const transitionMatrix,double* const stateProb,double* const emissionMatrix,const int* const observations,const int hiddenStates,const int differentObservables,const int T){
+//the timed part of a run with the buffers of ctx: EM steps until the log-likelihood converges, returns the number of steps
+int train(double* const transitionMatrix, double* const emissionMatrix, double* const stateProb, const int* const observations, context* const ctx, const int maxSteps){
 
-	double* ct = (double*) malloc( T * sizeof(double));
-	double* gamma_T = (double*) malloc(hiddenStates * T * sizeof(double));
-	double* gamma_sum = (double*) malloc(hiddenStates * T * sizeof(double));
-	double* a_new = (double*) malloc(hiddenStates * hiddenStates * sizeof(double));
-	double* b_new = (double*) malloc(differentObservables*hiddenStates * sizeof(double));
-	
-	for(int j=0;j<10;j++){
-		baum_welch(transitionMatrix, emissionMatrix, stateProb, observations, gamma_sum, gamma_T,a_new,b_new,ct, hiddenStates, differentObservables, T);
-	}
+	const int hiddenStates = ctx->N;
+	const int differentObservables = ctx->K;
+	const int T = ctx->T;
+	double* const gamma_T = ctx->gamma_T;
+	double* const gamma_sum = ctx->gamma_sum;
+	double* const a_new = ctx->a_new;
+	double* const b_new = ctx->b_new;
+	double* const ct = ctx->ct;
+	double* beta = ctx->beta;
+	double* beta_new = ctx->beta_new;
+	double* const alpha = ctx->alpha;
+	double* const ab = ctx->ab;
+	double logLikelihood=-DBL_MAX;
+	double disparance;
+	int steps=1;
 
-	free(ct);
-	free(gamma_T);
-	free(gamma_sum);
-	free(a_new);
-	free(b_new);
-	
-}
-
-
-int main(int argc, char *argv[]){
-
-	if(argc < 5){
-		printf("USAGE: ./run <seed> <hiddenStates> <observables> <T> \n");
-		return -1;
+	//FORWARD
+	PHASE_START(PHASE_TRANSPOSE);
+       	 
+	for(int row = 0 ; row < hiddenStates; row++){
+		for(int col =row+1; col < hiddenStates; col++){
+			double temp = transitionMatrix[col*hiddenStates+row];
+			transitionMatrix[col * hiddenStates+ row]  = transitionMatrix[row * hiddenStates + col];
+			transitionMatrix[row*hiddenStates + col] = temp;
+		}
 	}
+	PHASE_STOP(PHASE_TRANSPOSE);
+	PHASE_START(PHASE_FORWARD);
 
-	const int seed = atoi(argv[1]);  
-	const int hiddenStates = atoi(argv[2]); 
-	const int differentObservables = atoi(argv[3]); 
-	const int T = atoi(argv[4]);
-	
-	if(argc ==6){
-		int exp = atoi(argv[5]);
-		EPSILON  = pow(10,-exp);
-	}
 
-   	int minima=10;
-    	int variableSteps=100-cbrt(hiddenStates*differentObservables*T)/3;
-    	int maxSteps=minima < variableSteps ? variableSteps : minima;
-    	minima=1;    
-    	variableSteps=10-log10(hiddenStates*differentObservables*T);
-    	int maxRuns=minima < variableSteps ? variableSteps : minima;
-	double runs[maxRuns];
+	double ct0 = 0.0;
+	int y0 = observations[0];
 
-	srand(seed);
+	//compute alpha(0)
+	for(int s = 0; s < hiddenStates; s++){
+		double alphas = stateProb[s] * emissionMatrix[y0*hiddenStates + s];
+		ct0 += alphas;
+		alpha[s] = alphas;
+	}
 
-	//ground truth
-	double* groundTransitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
-	double* groundEmissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
-	makeMatrix(hiddenStates, hiddenStates, groundTransitionMatrix);
-	makeMatrix(hiddenStates, differentObservables, groundEmissionMatrix);
-	int groundInitialState = rand()%hiddenStates;
-	int* observations = (int*) malloc ( T * sizeof(int));
-	makeObservations(hiddenStates, differentObservables, groundInitialState, groundTransitionMatrix,groundEmissionMatrix,T, observations);
+	ct0 = 1.0 / ct0;
 
-	double* transitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
-	double* transitionMatrixSafe = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
-	double* transitionMatrixTesting=(double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+	for(int s = 0; s < hiddenStates; s++){
+		alpha[s] *= ct0;
+	}
 
-	double* emissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
-	double* emissionMatrixSafe = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
-	double* emissionMatrixTesting=(double*) malloc(hiddenStates*differentObservables*sizeof(double));
+	ct[0] = ct0;
 
-	double* stateProb  = (double*) malloc(hiddenStates * sizeof(double));
-	double* stateProbSafe  = (double*) malloc(hiddenStates * sizeof(double));
-	double* stateProbTesting  = (double*) malloc(hiddenStates * sizeof(double));
+	//compute alpha(t)
+	for(int t = 1; t < T-1; t++){
+		double ctt = 0.0;	
+		const int yt = observations[t];	
 
-	double* gamma_T = (double*) malloc( hiddenStates * sizeof(double));
-	double* gamma_sum = (double*) malloc( hiddenStates * sizeof(double));
-	double* a_new = (double*) malloc(hiddenStates * hiddenStates * sizeof(double));
-	double* b_new = (double*) malloc(differentObservables*hiddenStates * sizeof(double));
-	double* ct = (double*) malloc(T*sizeof(double));
-    	double* beta = (double*) malloc(hiddenStates  * sizeof(double));
-	double* beta_new = (double*) malloc(hiddenStates * sizeof(double));
-	double* alpha = (double*) malloc(hiddenStates * T * sizeof(double));
-	double* ab = (double*) malloc(hiddenStates * hiddenStates * differentObservables * sizeof(double));
-	
-	//random init transition matrix, emission matrix and state probabilities.
-	makeMatrix(hiddenStates, hiddenStates, transitionMatrix);
-	makeMatrix(hiddenStates, differentObservables, emissionMatrix);
-	makeProbabilities(stateProb,hiddenStates);
+		for(int s = 0; s<hiddenStates; s++){
+			double alphatNs = 0;
 
-	transpose(emissionMatrix, hiddenStates, differentObservables);
+			for(int j = 0; j < hiddenStates; j++){
+				alphatNs += alpha[(t-1)*hiddenStates + j] * transitionMatrix[s*hiddenStates + j];
+			}
 
-	//copy for resetting to initial state.
-	memcpy(transitionMatrixSafe, transitionMatrix, hiddenStates*hiddenStates*sizeof(double));
-   	memcpy(emissionMatrixSafe, emissionMatrix, hiddenStates*differentObservables*sizeof(double));
-    	memcpy(stateProbSafe, stateProb, hiddenStates * sizeof(double));
+			alphatNs *= emissionMatrix[yt*hiddenStates + s];
+			ctt += alphatNs;
+			alpha[t*hiddenStates + s] = alphatNs;
+		}
+ 
+		ctt = 1.0 / ctt;
+		
+		for(int s = 0; s<hiddenStates; s++){
+			alpha[t*hiddenStates+s] *= ctt;
+		}
 
-	//heat up cache
-	//heatup(transitionMatrix,stateProb,emissionMatrix,observations,hiddenStates,differentObservables,T);
-	
-	//matrix for flushing cache
-	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
+		ct[t] = ctt;
+	}
 
-	int steps = 0;
-	
-	for (int run=0; run<maxRuns; run++){
+	double ctt = 0.0;	
+	int yt = observations[T-1];
 
-		//reset to init
-		memcpy(transitionMatrix, transitionMatrixSafe, hiddenStates*hiddenStates*sizeof(double));
-   		memcpy(emissionMatrix, emissionMatrixSafe, hiddenStates*differentObservables*sizeof(double));
-        	memcpy(stateProb, stateProbSafe, hiddenStates * sizeof(double));
-		      		
-		double logLikelihood=-DBL_MAX;
-        	double disparance;
+	for(int s = 0; s<hiddenStates; s++){
+		double alphatNs = 0;
 
-		//only needed for testing with R
-		//write_init(transitionMatrix, emissionMatrix, observations, stateProb, hiddenStates, differentObservables, T);
-        
-        	steps=1;
-       	
-		_flush_cache(buf,BUFSIZE);
-		
-		myInt64 start = start_tsc();
-		
-		//FORWARD
-       	 
-		for(int row = 0 ; row < hiddenStates; row++){
-			for(int col =row+1; col < hiddenStates; col++){
-				double temp = transitionMatrix[col*hiddenStates+row];
-				transitionMatrix[col * hiddenStates+ row]  = transitionMatrix[row * hiddenStates + col];
-				transitionMatrix[row*hiddenStates + col] = temp;
-			}
+		for(int j = 0; j < hiddenStates; j++){
+			alphatNs += alpha[(T-2)*hiddenStates + j] * transitionMatrix[s*hiddenStates + j];	
 		}
-	
 
-		double ct0 = 0.0;
-		int y0 = observations[0];
+		alphatNs *= emissionMatrix[yt*hiddenStates + s];
+		ctt += alphatNs;
+		alpha[(T-1)*hiddenStates + s] = alphatNs;
+	}
 
-		//compute alpha(0)
-		for(int s = 0; s < hiddenStates; s++){
-			double alphas = stateProb[s] * emissionMatrix[y0*hiddenStates + s];
-			ct0 += alphas;
-			alpha[s] = alphas;
-		}
-	
-		ct0 = 1.0 / ct0;
-	
-		for(int s = 0; s < hiddenStates; s++){
-			alpha[s] *= ct0;
-		}
+	ctt = 1.0 / ctt;
 
-		ct[0] = ct0;
-	
-		//compute alpha(t)
-		for(int t = 1; t < T-1; t++){
-			double ctt = 0.0;	
-			const int yt = observations[t];	
+	for(int s = 0; s<hiddenStates; s++){
+		double alphaT1Ns = alpha[(T-1) * hiddenStates + s]*ctt;
+		alpha[(T-1)*hiddenStates+s] = alphaT1Ns;
+		gamma_T[s] = alphaT1Ns;
+	}
 
-			for(int s = 0; s<hiddenStates; s++){
-				double alphatNs = 0;
+	ct[T-1] = ctt;
+	PHASE_STOP(PHASE_FORWARD);
 
-				for(int j = 0; j < hiddenStates; j++){
-					alphatNs += alpha[(t-1)*hiddenStates + j] * transitionMatrix[s*hiddenStates + j];
-				}
 
-				alphatNs *= emissionMatrix[yt*hiddenStates + s];
-				ctt += alphatNs;
-				alpha[t*hiddenStates + s] = alphatNs;
-			}
- 
-			ctt = 1.0 / ctt;
-			
-			for(int s = 0; s<hiddenStates; s++){
-				alpha[t*hiddenStates+s] *= ctt;
-			}
+	//FUSED BACKWARD and UPDATE STEP
+	PHASE_START(PHASE_BACKWARD);
+
+	for(int s = 0; s < hiddenStates; s++){
+		beta[s] = ctt;
+		gamma_sum[s] = 0.0;
 
-			ct[t] = ctt;
+		for(int j = 0; j < hiddenStates; j++){
+			a_new[s*hiddenStates + j] =0.0;
 		}
+	}
 
-		double ctt = 0.0;	
-		int yt = observations[T-1];
+	for(int v = 0;  v < differentObservables; v++){
+		for(int s = 0; s < hiddenStates; s++){
+			b_new[v*hiddenStates + s] = 0.0;
+		}
+	}
+	PHASE_STOP(PHASE_BACKWARD);
+
+	PHASE_START(PHASE_TRANSPOSE);
+	for(int row = 0 ; row < hiddenStates; row++){
+		for(int col =row+1; col < hiddenStates; col++){
+			double temp = transitionMatrix[col*hiddenStates+row];
+			transitionMatrix[col * hiddenStates + row]  = transitionMatrix[row * hiddenStates + col];
+			transitionMatrix[row*hiddenStates + col] = temp;
+		}
+	}
 	
-		for(int s = 0; s<hiddenStates; s++){
-			double alphatNs = 0;
-
+	for(int v = 0; v < differentObservables; v++){
+		for(int s = 0; s < hiddenStates; s++){
 			for(int j = 0; j < hiddenStates; j++){
-				alphatNs += alpha[(T-2)*hiddenStates + j] * transitionMatrix[s*hiddenStates + j];	
+				ab[(v*hiddenStates + s) * hiddenStates + j] = transitionMatrix[s*hiddenStates + j] * emissionMatrix[v*hiddenStates +j];
 			}
-	
-			alphatNs *= emissionMatrix[yt*hiddenStates + s];
-			ctt += alphatNs;
-			alpha[(T-1)*hiddenStates + s] = alphatNs;
 		}
+	}
+	PHASE_STOP(PHASE_TRANSPOSE);
+	PHASE_START(PHASE_BACKWARD);
 
-		ctt = 1.0 / ctt;
-
-		for(int s = 0; s<hiddenStates; s++){
-			double alphaT1Ns = alpha[(T-1) * hiddenStates + s]*ctt;
-			alpha[(T-1)*hiddenStates+s] = alphaT1Ns;
-			gamma_T[s] = alphaT1Ns;
-		}
+    		yt = observations[T-1];
+	for(int t = T-1; t > 0; t--){
+		const int yt1 = observations[t-1];
+		const double ctt = ct[t-1];
 
-		ct[T-1] = ctt;
-	
-	
-		//FUSED BACKWARD and UPDATE STEP
-	
 		for(int s = 0; s < hiddenStates; s++){
-			beta[s] = ctt;
-			gamma_sum[s] = 0.0;
+			double beta_news = 0.0;
+			double alphat1Ns = alpha[(t-1)*hiddenStates + s];
 
 			for(int j = 0; j < hiddenStates; j++){
-				a_new[s*hiddenStates + j] =0.0;
-			}
-		}
-	
-		for(int v = 0;  v < differentObservables; v++){
-			for(int s = 0; s < hiddenStates; s++){
-				b_new[v*hiddenStates + s] = 0.0;
+				double temp =ab[(yt*hiddenStates + s)*hiddenStates + j] * beta[j];
+				double xi_sjt = alphat1Ns * temp;
+				a_new[s*hiddenStates+j] +=xi_sjt;
+				beta_news += temp;
 			}
-		}
 
-		for(int row = 0 ; row < hiddenStates; row++){
-			for(int col =row+1; col < hiddenStates; col++){
-				double temp = transitionMatrix[col*hiddenStates+row];
-				transitionMatrix[col * hiddenStates + row]  = transitionMatrix[row * hiddenStates + col];
-				transitionMatrix[row*hiddenStates + col] = temp;
-			}
+			double ps =alphat1Ns*beta_news;  
+			stateProb[s] = ps;
+			beta_new[s] = beta_news*ctt;
+			gamma_sum[s]+= ps ;
+        	    		b_new[yt1*hiddenStates+s]+=ps;
 		}
 		
-		for(int v = 0; v < differentObservables; v++){
-			for(int s = 0; s < hiddenStates; s++){
-				for(int j = 0; j < hiddenStates; j++){
-					ab[(v*hiddenStates + s) * hiddenStates + j] = transitionMatrix[s*hiddenStates + j] * emissionMatrix[v*hiddenStates +j];
-				}
-			}
-		}
+		double * temp = beta_new;
+		beta_new = beta;
+		beta = temp;
+		yt=yt1;
+	}
+	PHASE_STOP(PHASE_BACKWARD);
 
-    		yt = observations[T-1];
-		for(int t = T-1; t > 0; t--){
-			const int yt1 = observations[t-1];
-			const double ctt = ct[t-1];
-
-			for(int s = 0; s < hiddenStates; s++){
-				double beta_news = 0.0;
-				double alphat1Ns = alpha[(t-1)*hiddenStates + s];
-
-				for(int j = 0; j < hiddenStates; j++){
-					double temp =ab[(yt*hiddenStates + s)*hiddenStates + j] * beta[j];
-					double xi_sjt = alphat1Ns * temp;
-					a_new[s*hiddenStates+j] +=xi_sjt;
-					beta_news += temp;
-				}
+	do{
 
-				double ps =alphat1Ns*beta_news;  
-				stateProb[s] = ps;
-				beta_new[s] = beta_news*ctt;
-				gamma_sum[s]+= ps ;
-        	    		b_new[yt1*hiddenStates+s]+=ps;
-			}
-			
-			double * temp = beta_new;
-			beta_new = beta;
-			beta = temp;
-			yt=yt1;
-		}
-
-		do{
 
+	        int yt = observations[T-1];
+	        PHASE_START(PHASE_UPDATE);
 
-		        int yt = observations[T-1];
+	        //add remaining parts of the sum of gamma 
+	        for(int s = 0; s < hiddenStates; s++){
+		        double gamma_Ts = gamma_T[s];
+		        double gamma_sums = gamma_sum[s];
+		        double gamma_tot = gamma_Ts + gamma_sums;
+		        gamma_T[s] = 1./gamma_tot;
+		        gamma_sum[s] = 1./gamma_sums;
+        		        b_new[yt*hiddenStates+s]+=gamma_Ts;
+	        }
 
-		        //add remaining parts of the sum of gamma 
+	        //compute new emission matrix
+	        for(int v = 0; v < differentObservables; v++){
 		        for(int s = 0; s < hiddenStates; s++){
-			        double gamma_Ts = gamma_T[s];
-			        double gamma_sums = gamma_sum[s];
-			        double gamma_tot = gamma_Ts + gamma_sums;
-			        gamma_T[s] = 1./gamma_tot;
-			        gamma_sum[s] = 1./gamma_sums;
-        		        b_new[yt*hiddenStates+s]+=gamma_Ts;
+			        emissionMatrix[v*hiddenStates + s] = b_new[v*hiddenStates + s] * gamma_T[s];
+			        b_new[v*hiddenStates + s] = 0.0;
 		        }
-	
-		        //compute new emission matrix
-		        for(int v = 0; v < differentObservables; v++){
-			        for(int s = 0; s < hiddenStates; s++){
-				        emissionMatrix[v*hiddenStates + s] = b_new[v*hiddenStates + s] * gamma_T[s];
-				        b_new[v*hiddenStates + s] = 0.0;
+	        }
+	        PHASE_STOP(PHASE_UPDATE);
+
+	        //FORWARD
+
+	        //Transpose a_new
+	        PHASE_START(PHASE_TRANSPOSE);
+
+	        const int block_size = 4;
+
+	        for(int by = 0; by < hiddenStates; by+=block_size){
+		        const int end = by + block_size;
+
+		        for(int i = by; i < end-1; i++){
+			        for(int j = i+1; j < end; j++){
+				        double temp = a_new[i*hiddenStates+j];
+				        a_new[i * hiddenStates + j]  = a_new[j * hiddenStates + i];
+				        a_new[j*hiddenStates + i] = temp;			
 			        }
 		        }
-	
-		        //FORWARD
-	
-		        //Transpose a_new
-	
-		        const int block_size = 4;
-	
-		        for(int by = 0; by < hiddenStates; by+=block_size){
-			        const int end = by + block_size;
-
-			        for(int i = by; i < end-1; i++){
-				        for(int j = i+1; j < end; j++){
-					        double temp = a_new[i*hiddenStates+j];
-					        a_new[i * hiddenStates + j]  = a_new[j * hiddenStates + i];
-					        a_new[j*hiddenStates + i] = temp;			
+
+		        for(int bx = end; bx < hiddenStates; bx+= block_size){
+			        const int end_x = bx + block_size;
+
+			        for(int i = by; i < end; i++){
+				        for(int j = bx; j < end_x; j++){
+					        double temp = a_new[j*hiddenStates+i];
+					        a_new[j * hiddenStates + i]  = a_new[i * hiddenStates + j];
+					        a_new[i*hiddenStates + j] = temp;
 				        }
 			        }
+		        }	
+	        }
+	        PHASE_STOP(PHASE_TRANSPOSE);
+	        PHASE_START(PHASE_FORWARD);
 
-			        for(int bx = end; bx < hiddenStates; bx+= block_size){
-				        const int end_x = bx + block_size;
+	        double ctProduct = 1.0;
+	        long ctExponent = 0;
+	        double ctt = 0.0;
+	        int y0 = observations[0];
 
-				        for(int i = by; i < end; i++){
-					        for(int j = bx; j < end_x; j++){
-						        double temp = a_new[j*hiddenStates+i];
-						        a_new[j * hiddenStates + i]  = a_new[i * hiddenStates + j];
-						        a_new[i*hiddenStates + j] = temp;
-					        }
-				        }
-			        }	
-		        }
-	
-		        double ctt = 0.0;
-		        int y0 = observations[0];
+	        //compute alpha(0)
+	        for(int s = 0; s < hiddenStates; s++){
+		        double alphas = stateProb[s] * emissionMatrix[y0*hiddenStates + s];
+		        ctt += alphas;
+		        alpha[s] = alphas;
+	        }
+	        
+	        ctt = 1.0 / ctt;
 
-		        //compute alpha(0)
-		        for(int s = 0; s < hiddenStates; s++){
-			        double alphas = stateProb[s] * emissionMatrix[y0*hiddenStates + s];
-			        ctt += alphas;
-			        alpha[s] = alphas;
-		        }
-		        
-		        ctt = 1.0 / ctt;
-	
-		        for(int s = 0; s < hiddenStates; s++){
-			        alpha[s] *= ctt;
+	        for(int s = 0; s < hiddenStates; s++){
+		        alpha[s] *= ctt;
+	        }
+
+	        ct[0] = ctt;
+	        scaleProduct(&ctProduct, &ctExponent, ctt);
+	        ctt = 0.0;	
+	        yt = observations[1];	
+
+	        //Compute alpha(1) and scale transitionMatrix
+	        for(int s = 0; s<hiddenStates-1; s++){
+		        double alphatNs = 0;
+
+		        for(int j = 0; j < hiddenStates; j++){
+			        double asNj =  a_new[s*hiddenStates + j] * gamma_sum[j];
+			        a_new[s*hiddenStates+j] = 0.0;
+			        transitionMatrix[s*hiddenStates + j] = asNj;
+			        alphatNs += alpha[0*hiddenStates + j] * asNj;
 		        }
 
-		        ct[0] = ctt;
+		        alphatNs *= emissionMatrix[yt*hiddenStates + s];
+		        ctt += alphatNs;
+		        alpha[1*hiddenStates + s] = alphatNs;
+	        }
+	        
+	        double alphatNs = 0;
+	        for(int j = 0; j < hiddenStates; j++){
+		        double gamma_sumj = gamma_sum[j];
+		        gamma_sum[j] =0.0;
+		        double asNj =  a_new[(hiddenStates-1)*hiddenStates + j] * gamma_sumj;
+		        transitionMatrix[(hiddenStates-1)*hiddenStates + j] = asNj;
+		        alphatNs += alpha[0*hiddenStates + j] * asNj;
+		        a_new[(hiddenStates-1)*hiddenStates+j] = 0.0;
+	        }
+
+	        alphatNs *= emissionMatrix[yt*hiddenStates + (hiddenStates-1)];
+	        ctt += alphatNs;
+	        alpha[1*hiddenStates + (hiddenStates-1)] = alphatNs;
+	        ctt = 1.0 / ctt;
+	        
+	        for(int s = 0; s<hiddenStates; s++){
+		        alpha[1*hiddenStates+s] *= ctt;
+	        }
+
+	        ct[1] = ctt;
+	        scaleProduct(&ctProduct, &ctExponent, ctt);
+
+	        for(int t = 2; t < T-1; t++){
 		        ctt = 0.0;	
-		        yt = observations[1];	
+		        yt = observations[t];	
 
-		        //Compute alpha(1) and scale transitionMatrix
-		        for(int s = 0; s<hiddenStates-1; s++){
+		        for(int s = 0; s<hiddenStates; s++){
 			        double alphatNs = 0;
 
 			        for(int j = 0; j < hiddenStates; j++){
-				        double asNj =  a_new[s*hiddenStates + j] * gamma_sum[j];
-				        a_new[s*hiddenStates+j] = 0.0;
-				        transitionMatrix[s*hiddenStates + j] = asNj;
-				        alphatNs += alpha[0*hiddenStates + j] * asNj;
+				        alphatNs += alpha[(t-1)*hiddenStates + j] *transitionMatrix[s*hiddenStates + j];
 			        }
 
 			        alphatNs *= emissionMatrix[yt*hiddenStates + s];
 			        ctt += alphatNs;
-			        alpha[1*hiddenStates + s] = alphatNs;
+			        alpha[t*hiddenStates + s] = alphatNs;
 		        }
+ 
+		        ctt = 1.0 / ctt;
 		        
+		        for(int s = 0; s<hiddenStates; s++){
+			        alpha[t*hiddenStates+s] *= ctt;
+		        }
+
+		        ct[t] = ctt;
+		        scaleProduct(&ctProduct, &ctExponent, ctt);
+	        }
+
+	        ctt = 0.0;	
+	        yt = observations[T-1];	
+
+	        //compute alpha(T-1)
+	        for(int s = 0; s<hiddenStates; s++){
 		        double alphatNs = 0;
+
 		        for(int j = 0; j < hiddenStates; j++){
-			        double gamma_sumj = gamma_sum[j];
-			        gamma_sum[j] =0.0;
-			        double asNj =  a_new[(hiddenStates-1)*hiddenStates + j] * gamma_sumj;
-			        transitionMatrix[(hiddenStates-1)*hiddenStates + j] = asNj;
-			        alphatNs += alpha[0*hiddenStates + j] * asNj;
-			        a_new[(hiddenStates-1)*hiddenStates+j] = 0.0;
+		        	alphatNs += alpha[(T-2)*hiddenStates + j] * transitionMatrix[s*hiddenStates + j];
 		        }
 
-		        alphatNs *= emissionMatrix[yt*hiddenStates + (hiddenStates-1)];
+		        alphatNs *= emissionMatrix[yt*hiddenStates + s];
 		        ctt += alphatNs;
-		        alpha[1*hiddenStates + (hiddenStates-1)] = alphatNs;
-		        ctt = 1.0 / ctt;
+		        alpha[(T-1)*hiddenStates + s] = alphatNs;
+	        }
+
+	        ctt = 1.0 / ctt;
 		        
-		        for(int s = 0; s<hiddenStates; s++){
-			        alpha[1*hiddenStates+s] *= ctt;
-		        }
+	        for(int s = 0; s<hiddenStates; s++){
+		        double alphaT1Ns = alpha[(T-1) * hiddenStates + s]*ctt;
+		        alpha[(T-1)*hiddenStates+s] = alphaT1Ns;
+		        gamma_T[s] = alphaT1Ns;
+	        }
 
-		        ct[1] = ctt;
-	
-		        for(int t = 2; t < T-1; t++){
-			        ctt = 0.0;	
-			        yt = observations[t];	
+	        ct[T-1] = ctt;
+	        scaleProduct(&ctProduct, &ctExponent, ctt);
+	        PHASE_STOP(PHASE_FORWARD);
 
-			        for(int s = 0; s<hiddenStates; s++){
-				        double alphatNs = 0;
+	        //FUSED BACKWARD and UPDATE STEP
+	        PHASE_START(PHASE_TRANSPOSE);
 
-				        for(int j = 0; j < hiddenStates; j++){
-					        alphatNs += alpha[(t-1)*hiddenStates + j] *transitionMatrix[s*hiddenStates + j];
-				        }
+	        for(int by = 0; by < hiddenStates; by+=block_size){
+		        const int end = by + block_size;
 
-				        alphatNs *= emissionMatrix[yt*hiddenStates + s];
-				        ctt += alphatNs;
-				        alpha[t*hiddenStates + s] = alphatNs;
+		        for(int i = by; i < end-1; i++){
+			        for(int j = i+1; j < end; j++){
+				        double temp = transitionMatrix[i*hiddenStates+j];
+				        transitionMatrix[i * hiddenStates + j]  = transitionMatrix[j * hiddenStates + i];
+				        transitionMatrix[j*hiddenStates + i] = temp;				
 			        }
- 
-			        ctt = 1.0 / ctt;
-			        
-			        for(int s = 0; s<hiddenStates; s++){
-				        alpha[t*hiddenStates+s] *= ctt;
-			        }
-
-			        ct[t] = ctt;
 		        }
 
-		        ctt = 0.0;	
-		        yt = observations[T-1];	
-
-		        //compute alpha(T-1)
-		        for(int s = 0; s<hiddenStates; s++){
-			        double alphatNs = 0;
+		        for(int bx = end; bx < hiddenStates; bx+= block_size){
+			        const int end_x = block_size + bx;
 
+			        for(int i = by; i < end; i++){
+				        for(int j = bx; j < end_x; j++){
+					        double temp = transitionMatrix[j*hiddenStates+i];
+					        transitionMatrix[j * hiddenStates + i]  = transitionMatrix[i * hiddenStates + j];
+					        transitionMatrix[i*hiddenStates + j] = temp;
+				        }
+			        }
+		        }	
+	        }
+	        
+	        for(int v = 0; v < differentObservables; v++){
+		        for(int s = 0; s < hiddenStates; s++){
 			        for(int j = 0; j < hiddenStates; j++){
-			        	alphatNs += alpha[(T-2)*hiddenStates + j] * transitionMatrix[s*hiddenStates + j];
+				        ab[(v*hiddenStates + s) * hiddenStates + j] = transitionMatrix[s*hiddenStates + j] * emissionMatrix[v*hiddenStates +j];
 			        }
-	
-			        alphatNs *= emissionMatrix[yt*hiddenStates + s];
-			        ctt += alphatNs;
-			        alpha[(T-1)*hiddenStates + s] = alphatNs;
 		        }
+        	}
+	        PHASE_STOP(PHASE_TRANSPOSE);
+	        PHASE_START(PHASE_BACKWARD);
 
-		        ctt = 1.0 / ctt;
-			        
-		        for(int s = 0; s<hiddenStates; s++){
-			        double alphaT1Ns = alpha[(T-1) * hiddenStates + s]*ctt;
-			        alpha[(T-1)*hiddenStates+s] = alphaT1Ns;
-			        gamma_T[s] = alphaT1Ns;
-		        }
+        	for(int s = 0; s < hiddenStates; s++){
+		        beta[s] = ctt;
+        	}
 
-		        ct[T-1] = ctt;
-	
-		        //FUSED BACKWARD and UPDATE STEP
-	
-		        for(int by = 0; by < hiddenStates; by+=block_size){
-			        const int end = by + block_size;
-
-			        for(int i = by; i < end-1; i++){
-				        for(int j = i+1; j < end; j++){
-					        double temp = transitionMatrix[i*hiddenStates+j];
-					        transitionMatrix[i * hiddenStates + j]  = transitionMatrix[j * hiddenStates + i];
-					        transitionMatrix[j*hiddenStates + i] = temp;				
-				        }
-			        }
+            		yt= observations[T-1];
+        	for(int t = T-1; t > 0; t--){
+		        const int yt1 = observations[t-1];
+		        ctt = ct[t-1];
 
-			        for(int bx = end; bx < hiddenStates; bx+= block_size){
-				        const int end_x = block_size + bx;
+	        	for(int s = 0; s < hiddenStates ; s++){
+			        double beta_news = 0.0;
+			        double alphat1Ns = alpha[(t-1)*hiddenStates + s];
 
-				        for(int i = by; i < end; i++){
-					        for(int j = bx; j < end_x; j++){
-						        double temp = transitionMatrix[j*hiddenStates+i];
-						        transitionMatrix[j * hiddenStates + i]  = transitionMatrix[i * hiddenStates + j];
-						        transitionMatrix[i*hiddenStates + j] = temp;
-					        }
-				        }
-			        }	
-		        }
-		        
-		        for(int v = 0; v < differentObservables; v++){
-			        for(int s = 0; s < hiddenStates; s++){
-				        for(int j = 0; j < hiddenStates; j++){
-					        ab[(v*hiddenStates + s) * hiddenStates + j] = transitionMatrix[s*hiddenStates + j] * emissionMatrix[v*hiddenStates +j];
-				        }
+			        for(int j = 0; j < hiddenStates; j++){
+				        double temp = ab[(yt*hiddenStates + s)*hiddenStates + j] * beta[j];
+				        a_new[s*hiddenStates+j] +=alphat1Ns * temp;
+				        beta_news += temp;
 			        }
-	        	}
-	
-	        	for(int s = 0; s < hiddenStates; s++){
-			        beta[s] = ctt;
-	        	}
-	
-            		yt= observations[T-1];
-	        	for(int t = T-1; t > 0; t--){
-			        const int yt1 = observations[t-1];
-			        ctt = ct[t-1];
-
-		        	for(int s = 0; s < hiddenStates ; s++){
-				        double beta_news = 0.0;
-				        double alphat1Ns = alpha[(t-1)*hiddenStates + s];
-
-				        for(int j = 0; j < hiddenStates; j++){
-					        double temp = ab[(yt*hiddenStates + s)*hiddenStates + j] * beta[j];
-					        a_new[s*hiddenStates+j] +=alphat1Ns * temp;
-					        beta_news += temp;
-				        }
 
-				        double ps =alphat1Ns*beta_news;  
-				        stateProb[s] = ps;
-				        beta_new[s] = beta_news*ctt;
-				        gamma_sum[s]+= ps;
+			        double ps =alphat1Ns*beta_news;  
+			        stateProb[s] = ps;
+			        beta_new[s] = beta_news*ctt;
+			        gamma_sum[s]+= ps;
         	          		b_new[yt1*hiddenStates+s]+=ps;
-			        }
-
-			        double * temp = beta_new;
-			        beta_new = beta;
-			        beta = temp;
-			        yt=yt1;	
 		        }
 
+		        double * temp = beta_new;
+		        beta_new = beta;
+		        beta = temp;
+		        yt=yt1;	
+	        }
+	        PHASE_STOP(PHASE_BACKWARD);
+
+	        PHASE_START(PHASE_FINISHED);
         	    	steps+=1;
-			
-			//Finishing
-		        double oldLogLikelihood=logLikelihood;
-		        double newLogLikelihood = 0.0;
-	
-		        for(int time = 0; time < T; time++){
-			        newLogLikelihood -= log2(ct[time]);
-		        }
-	        
-		        logLikelihood=newLogLikelihood;
-		        disparance=newLogLikelihood-oldLogLikelihood;
+		
+		//Finishing
+	        double oldLogLikelihood=logLikelihood;
+	        double newLogLikelihood = productLogLikelihood(ctProduct, ctExponent);
+        
+	        logLikelihood=newLogLikelihood;
+	        disparance=newLogLikelihood-oldLogLikelihood;
+	        PHASE_STOP(PHASE_FINISHED);
 
-		}while (disparance>EPSILON && steps<maxSteps);
+	}while (disparance>EPSILON && steps<maxSteps);
 
-		//Final scale		
-	        //compute new transition matrix
-	        for(int s = 0; s < hiddenStates; s++){
-		        double gamma_sums_inv = 1./gamma_sum[s];
+	//Final scale		
+	PHASE_START(PHASE_UPDATE);
+        //compute new transition matrix
+        for(int s = 0; s < hiddenStates; s++){
+	        double gamma_sums_inv = 1./gamma_sum[s];
 
-		        for(int j = 0; j < hiddenStates; j++){
-			        transitionMatrix[s*hiddenStates+j] = a_new[s*hiddenStates+j]*gamma_sums_inv;
-		        }
+	        for(int j = 0; j < hiddenStates; j++){
+		        transitionMatrix[s*hiddenStates+j] = a_new[s*hiddenStates+j]*gamma_sums_inv;
 	        }
+        }
 
-	        yt =observations[T-1];
+        yt =observations[T-1];
 
-	        //add remaining parts of the sum of gamma 
-	        for(int s = 0; s < hiddenStates; s++){	
-		        double gamma_Ts = gamma_T[s];
-		        double gamma_tot = gamma_Ts + gamma_sum[s];
-		        gamma_T[s] = 1./gamma_tot;
+        //add remaining parts of the sum of gamma 
+        for(int s = 0; s < hiddenStates; s++){	
+	        double gamma_Ts = gamma_T[s];
+	        double gamma_tot = gamma_Ts + gamma_sum[s];
+	        gamma_T[s] = 1./gamma_tot;
                 	b_new[yt*hiddenStates+s]+=gamma_Ts;
-	        }
+        }
 
-	        //compute new emission matrix
-	        for(int v = 0; v < differentObservables; v++){
-		        for(int s = 0; s < hiddenStates; s++){
-			        emissionMatrix[v*hiddenStates + s] = b_new[v*hiddenStates + s] * gamma_T[s];
-		        }
+        //compute new emission matrix
+        for(int v = 0; v < differentObservables; v++){
+	        for(int s = 0; s < hiddenStates; s++){
+		        emissionMatrix[v*hiddenStates + s] = b_new[v*hiddenStates + s] * gamma_T[s];
 	        }
+        }
+	PHASE_STOP(PHASE_UPDATE);
+
+	return steps;
+}
+
+//arena of the runs of the benchmark driver, kept over all runs and points like main keeps its own (it only grows)
+static context benchContext = {0};
+
+static void bench_run(const problem* const pb, measurement* const m){
+
+	const int hiddenStates = pb->N;
+	const int differentObservables = pb->K;
+	const int T = pb->T;
+
+	makeContext(&benchContext, hiddenStates, differentObservables, T);
+
+	memcpy(m->transitionMatrix, pb->transitionMatrix, hiddenStates*hiddenStates*sizeof(double));
+	memcpy(m->emissionMatrix, pb->emissionMatrix, hiddenStates*differentObservables*sizeof(double));
+	memcpy(m->stateProb, pb->stateProb, hiddenStates * sizeof(double));
+	EPSILON = pb->epsilon;
+
+	//observable major like in main
+	transpose(m->emissionMatrix, hiddenStates, differentObservables);
+
+	resetPhases(phases);
+	_flush_cache(pb->buf,pb->bufsize);
+	myInt64 start = start_tsc();
+
+	m->steps = train(m->transitionMatrix, m->emissionMatrix, m->stateProb, pb->observations, &benchContext, pb->maxSteps);
+
+	m->cycles = stop_tsc(start);
+	memcpy(m->phases, phases, sizeof(phases));
+
+	transpose(m->emissionMatrix, differentObservables, hiddenStates);
+}
+
+const variant bench_reo = {"reo", 4, 1, bench_run};
+
+void heatup(double* const transitionMatrix,double* const stateProb,double* const emissionMatrix,const int* const observations,context* const ctx){
+
+	for(int j=0;j<10;j++){
+		baum_welch(transitionMatrix, emissionMatrix, stateProb, observations, ctx);
+	}
+}
+
+
+int main(int argc, char *argv[]){
+
+	if(argc < 5){
+		printf("USAGE: ./run <seed> <hiddenStates> <observables> <T> \n");
+		return -1;
+	}
+
+	const int seed = atoi(argv[1]);  
+	const int hiddenStates = atoi(argv[2]); 
+	const int differentObservables = atoi(argv[3]); 
+	const int T = atoi(argv[4]);
+	
+	if(argc ==6){
+		int exp = atoi(argv[5]);
+		EPSILON  = pow(10,-exp);
+	}
+
+   	int minima=10;
+    	int variableSteps=100-cbrt(hiddenStates*differentObservables*T)/3;
+    	int maxSteps=minima < variableSteps ? variableSteps : minima;
+    	minima=1;    
+    	variableSteps=10-log10(hiddenStates*differentObservables*T);
+    	int maxRuns=minima < variableSteps ? variableSteps : minima;
+	double runs[maxRuns];
+
+	srand(seed);
+
+	//ground truth
+	double* groundTransitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+	double* groundEmissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+	makeMatrix(hiddenStates, hiddenStates, groundTransitionMatrix);
+	makeMatrix(hiddenStates, differentObservables, groundEmissionMatrix);
+	int groundInitialState = rand()%hiddenStates;
+	int* observations = (int*) malloc ( T * sizeof(int));
+	makeObservations(hiddenStates, differentObservables, groundInitialState, groundTransitionMatrix,groundEmissionMatrix,T, observations);
+
+	double* transitionMatrix = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+	double* transitionMatrixSafe = (double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+	double* transitionMatrixTesting=(double*) malloc(hiddenStates*hiddenStates*sizeof(double));
+
+	double* emissionMatrix = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+	double* emissionMatrixSafe = (double*) malloc(hiddenStates*differentObservables*sizeof(double));
+	double* emissionMatrixTesting=(double*) malloc(hiddenStates*differentObservables*sizeof(double));
+
+	double* stateProb  = (double*) malloc(hiddenStates * sizeof(double));
+	double* stateProbSafe  = (double*) malloc(hiddenStates * sizeof(double));
+	double* stateProbTesting  = (double*) malloc(hiddenStates * sizeof(double));
+
+	//buffers of the training, carved once and reused by all runs
+	context ctx = {0};
+	makeContext(&ctx, hiddenStates, differentObservables, T);
+	
+	//random init transition matrix, emission matrix and state probabilities.
+	makeMatrix(hiddenStates, hiddenStates, transitionMatrix);
+	makeMatrix(hiddenStates, differentObservables, emissionMatrix);
+	makeProbabilities(stateProb,hiddenStates);
+
+	transpose(emissionMatrix, hiddenStates, differentObservables);
+
+	//copy for resetting to initial state.
+	memcpy(transitionMatrixSafe, transitionMatrix, hiddenStates*hiddenStates*sizeof(double));
+   	memcpy(emissionMatrixSafe, emissionMatrix, hiddenStates*differentObservables*sizeof(double));
+    	memcpy(stateProbSafe, stateProb, hiddenStates * sizeof(double));
+
+	//heat up cache
+	//heatup(transitionMatrix,stateProb,emissionMatrix,observations,&ctx);
+	
+	//matrix for flushing cache
+	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
+
+	int steps = 0;
+	long totalSteps = 0;
+	
+	for (int run=0; run<maxRuns; run++){
+
+		//reset to init
+		memcpy(transitionMatrix, transitionMatrixSafe, hiddenStates*hiddenStates*sizeof(double));
+   		memcpy(emissionMatrix, emissionMatrixSafe, hiddenStates*differentObservables*sizeof(double));
+        	memcpy(stateProb, stateProbSafe, hiddenStates * sizeof(double));
+		      		
+		//only needed for testing with R
+		//write_init(transitionMatrix, emissionMatrix, observations, stateProb, hiddenStates, differentObservables, T);
+       	
+		_flush_cache(buf,BUFSIZE);
+		
+		myInt64 start = start_tsc();
+
+		steps = train(transitionMatrix, emissionMatrix, stateProb, observations, &ctx, maxSteps);
 
 		myInt64 cycles = stop_tsc(start);
         	cycles = cycles/steps;
 		runs[run]=cycles;
+		totalSteps+=steps;
 
 	}
 
 	qsort (runs, maxRuns, sizeof (double), compare_doubles);
   	double medianTime = runs[maxRuns/2];
 	printf("Median Time: \t %lf cycles \n", medianTime); 
+	printPhases(phases, totalSteps);
 
 	//write_result(transitionMatrix, emissionMatrix, observations, stateProb, steps, hiddenStates, differentObservables, T);
 
@@ -1018,11 +1101,6 @@ int main(int argc, char *argv[]){
 	free(transitionMatrix);
 	free(emissionMatrix);
 	free(stateProb);
-   	free(ct);
-	free(gamma_T);
-	free(gamma_sum);
-	free(a_new);
-	free(b_new);
   	free(transitionMatrixSafe);
 	free(emissionMatrixSafe);
    	free(stateProbSafe);
@@ -1030,6 +1108,7 @@ int main(int argc, char *argv[]){
 	free(emissionMatrixTesting);
 	free(stateProbTesting);
 	free((void*)buf);
+	freeContext(&ctx);
 
 	return 0; 
 } 
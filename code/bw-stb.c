@@ -8,16 +8,23 @@
 #include "util.h"
 #include "io.h"
 #include "tested.h"
+#include "bench.h"
 
 
 double EPSILON = 1e-4;
 #define DELTA 1e-2
 #define BUFSIZE 1<<26
 
+//cycles and calls of the phases of train (only counted with -DPHASES)
+static phase phases[PHASE_COUNT];
 
 
-void forward(const double* const a, const double* const p, const double* const b, double* const alpha,  const int * const y, double* const ct, const int N, const int K, const int T){
 
+//returns the log-likelihood of y, accumulated from the ct(t) on the way
+double forward(const double* const a, const double* const p, const double* const b, double* const alpha,  const int * const y, double* const ct, const int N, const int K, const int T){
+
+	double ctProduct = 1.0;
+	long ctExponent = 0;
 	ct[0]=0.0;
 
 	//compute alpha(0)
@@ -27,6 +34,7 @@ void forward(const double* const a, const double* const p, const double* const b
 	}
 	
 	ct[0] = 1.0 / ct[0];
+	scaleProduct(&ctProduct, &ctExponent, ct[0]);
 
 	for(int s = 0; s < N; s++){
 		alpha[s*T] *= ct[0];
@@ -48,13 +56,14 @@ void forward(const double* const a, const double* const p, const double* const b
 		}
  
 		ct[t] = 1.0 / ct[t];
+		scaleProduct(&ctProduct, &ctExponent, ct[t]);
 		
 		for(int s = 0; s<N; s++){
 			alpha[s*T + t] *= ct[t];
 		}	
 	}
 
-	return;
+	return productLogLikelihood(ctProduct, ctExponent);
 }
 
 
@@ -134,6 +143,69 @@ void update(double* const a, double* const p, double* const b, const double* con
 
 
 
+//the timed part of a run: EM steps until the log-likelihood converges, returns the number of steps
+int train(double* const transitionMatrix, double* const stateProb, double* const emissionMatrix, const int* const observations, double* const alpha, double* const beta, double* const gamma, double* const xi, double* const ct, const int hiddenStates, const int differentObservables, const int T, const int maxSteps){
+
+	double logLikelihood=-DBL_MAX;
+	double newLogLikelihood;
+	int steps=0;
+
+	do{
+		PHASE_START(PHASE_FORWARD);
+		newLogLikelihood = forward(transitionMatrix, stateProb, emissionMatrix, alpha, observations, ct, hiddenStates, differentObservables, T);	
+		PHASE_STOP(PHASE_FORWARD);
+
+		PHASE_START(PHASE_BACKWARD);
+		backward(transitionMatrix, emissionMatrix, beta,observations, ct, hiddenStates, differentObservables, T);
+		PHASE_STOP(PHASE_BACKWARD);
+
+		PHASE_START(PHASE_UPDATE);
+		update(transitionMatrix, stateProb, emissionMatrix, alpha, beta, gamma, xi, observations, ct, hiddenStates, differentObservables, T);
+		PHASE_STOP(PHASE_UPDATE);
+
+		steps+=1;
+
+	}while (!finished(newLogLikelihood, &logLikelihood, EPSILON) && steps<maxSteps);
+
+	return steps;
+}
+
+//one run for the benchmark driver, the model is trained in place in m
+static void bench_run(const problem* const pb, measurement* const m){
+
+	const int hiddenStates = pb->N;
+	const int differentObservables = pb->K;
+	const int T = pb->T;
+
+	double* alpha = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* beta = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* gamma = (double*) malloc(hiddenStates * T * sizeof(double));
+	double* xi = (double*) malloc(hiddenStates * hiddenStates * (T-1) * sizeof(double)); 
+	double* ct = (double*) malloc(T*sizeof(double));
+
+	memcpy(m->transitionMatrix, pb->transitionMatrix, hiddenStates*hiddenStates*sizeof(double));
+	memcpy(m->emissionMatrix, pb->emissionMatrix, hiddenStates*differentObservables*sizeof(double));
+	memcpy(m->stateProb, pb->stateProb, hiddenStates * sizeof(double));
+	EPSILON = pb->epsilon;
+
+	resetPhases(phases);
+	_flush_cache(pb->buf,pb->bufsize);
+	myInt64 start = start_tsc();
+
+	m->steps = train(m->transitionMatrix, m->stateProb, m->emissionMatrix, pb->observations, alpha, beta, gamma, xi, ct, hiddenStates, differentObservables, T, pb->maxSteps);
+
+	m->cycles = stop_tsc(start);
+	memcpy(m->phases, phases, sizeof(phases));
+
+	free(alpha);
+	free(beta);
+	free(gamma);
+	free(xi);
+	free(ct);
+}
+
+const variant bench_stb = {"stb", 1, 1, bench_run};
+
 void heatup(double* const transitionMatrix,double* const piVector,double* const emissionMatrix,const int* const observations,const int hiddenStates,const int differentObservables,const int T){
 
 	double* alpha = (double*) malloc(hiddenStates * T * sizeof(double));
@@ -230,6 +302,7 @@ int main(int argc, char *argv[]){
 	volatile unsigned char* buf = malloc(BUFSIZE*sizeof(char));
         
 	int steps = 0;
+	long totalSteps = 0;
 	
 	for (int run=0; run<maxRuns; run++){
 
@@ -238,31 +311,24 @@ int main(int argc, char *argv[]){
 	   	memcpy(emissionMatrix, emissionMatrixSafe, hiddenStates*differentObservables*sizeof(double));
         	memcpy(stateProb, stateProbSafe, hiddenStates * sizeof(double));	
 	
-        	double logLikelihood=-DBL_MAX;
-
 		//only needed for testing with R
 		//write_init(transitionMatrix, emissionMatrix, observations, stateProb, hiddenStates, differentObservables, T);
         
-        	steps=0;
 	        _flush_cache(buf,BUFSIZE); 
 		start = start_tsc();
 
-		do{
-			forward(transitionMatrix, stateProb, emissionMatrix, alpha, observations, ct, hiddenStates, differentObservables, T);	
-			backward(transitionMatrix, emissionMatrix, beta,observations, ct, hiddenStates, differentObservables, T);
-			update(transitionMatrix, stateProb, emissionMatrix, alpha, beta, gamma, xi, observations, ct, hiddenStates, differentObservables, T);
-            		steps+=1;
-            		
-		}while (!finished(ct, &logLikelihood, hiddenStates, T,EPSILON) && steps<maxSteps);
+		steps = train(transitionMatrix, stateProb, emissionMatrix, observations, alpha, beta, gamma, xi, ct, hiddenStates, differentObservables, T, maxSteps);
 
 		cycles = stop_tsc(start);
         	cycles = cycles/steps;
 		runs[run]=cycles;
+		totalSteps+=steps;
 	}
 
 	qsort (runs, maxRuns, sizeof (double), compare_doubles);
   	double medianTime = runs[maxRuns/2];
 	printf("Median Time: \t %lf cycles \n", medianTime); 
+	printPhases(phases, totalSteps);
 
 	//write_result(transitionMatrix, emissionMatrix, observations, stateProb, steps, hiddenStates, differentObservables, T);
 
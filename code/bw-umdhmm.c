@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tsc_x86.h"
+#include "util.h"
+#include "bench.h"
+#include "../umdhmm/nrutil.h"
+#include "../umdhmm/hmm.h"
+
+//umdhmm (../umdhmm) as a variant of the benchmark driver, it has no main of its own here
+//BaumWelch keeps its own convergence (DELTA 0.001 in ln, at most MAX_STEPS) and smoothes the model with .001,
+//so pb->epsilon and pb->maxSteps are ignored and the result is not checked against tested_implementation
+
+static void bench_run(const problem* const pb, measurement* const m){
+
+	const int N = pb->N;
+	const int K = pb->K;
+	const int T = pb->T;
+
+	//umdhmm counts from 1
+	HMM hmm;
+	hmm.N = N;
+	hmm.M = K;
+	hmm.A = dmatrix(1, N, 1, N);
+	hmm.B = dmatrix(1, N, 1, K);
+	hmm.pi = dvector(1, N);
+
+	for(int i = 0; i < N; i++){
+		hmm.pi[i+1] = pb->stateProb[i];
+
+		for(int j = 0; j < N; j++){
+			hmm.A[i+1][j+1] = pb->transitionMatrix[i*N + j];
+		}
+
+		for(int v = 0; v < K; v++){
+			hmm.B[i+1][v+1] = pb->emissionMatrix[i*K + v];
+		}
+	}
+
+	int* O = ivector(1, T);
+
+	for(int t = 0; t < T; t++){
+		O[t+1] = pb->observations[t] + 1;
+	}
+
+	double** alpha = dmatrix(1, T, 1, N);
+	double** beta = dmatrix(1, T, 1, N);
+	double** gamma = dmatrix(1, T, 1, N);
+	int niter;
+	double logprobinit, logprobfinal;
+
+	_flush_cache(pb->buf,pb->bufsize);
+	myInt64 start = start_tsc();
+
+	BaumWelch(&hmm, T, O, alpha, beta, gamma, &niter, &logprobinit, &logprobfinal);
+
+	m->cycles = stop_tsc(start);
+	m->steps = niter + 1;
+
+	for(int i = 0; i < N; i++){
+		m->stateProb[i] = hmm.pi[i+1];
+
+		for(int j = 0; j < N; j++){
+			m->transitionMatrix[i*N + j] = hmm.A[i+1][j+1];
+		}
+
+		for(int v = 0; v < K; v++){
+			m->emissionMatrix[i*K + v] = hmm.B[i+1][v+1];
+		}
+	}
+
+	free_dmatrix(alpha, 1, T, 1, N);
+	free_dmatrix(beta, 1, T, 1, N);
+	free_dmatrix(gamma, 1, T, 1, N);
+	free_ivector(O, 1, T);
+	free_dmatrix(hmm.A, 1, N, 1, N);
+	free_dmatrix(hmm.B, 1, N, 1, K);
+	free_dvector(hmm.pi, 1, N);
+}
+
+const variant bench_umdhmm = {"umdhmm", 1, 0, bench_run};
@@ -0,0 +1,90 @@
+#ifndef BW_FILE_
+#define BW_FILE_
+
+//libbaumwelch: the vectorized Baum-Welch engine of bw-vec.c as a linkable library.
+//All matrices passed in or out are row major and state major:
+//transitionMatrix[s*N + j], emissionMatrix[s*K + v], stateProb[s].
+//Log-likelihoods are base 2, like the finishing criteria of the benchmark harnesses.
+
+typedef struct bw_model bw_model;
+
+//precision of the engine, the model itself is always kept in double
+enum {
+	BW_DOUBLE = 0,
+	BW_FLOAT = 1,	//8 floats per register
+	BW_MIXED = 2	//alpha stored in float, computations and sums in double
+};
+
+//where the backward step gets the products a(s,j)*b(v,j) from
+enum {
+	BW_AB_AUTO = 0,		//pick by the size of the table and the L2 cache
+	BW_AB_FULL = 1,		//table for all K observables (K*N*N doubles)
+	BW_AB_PRESENT = 2,	//table only for the observables that occur in the sequences
+	BW_AB_ON_THE_FLY = 3	//no table, b is folded into beta (scaled double precision only, else BW_AB_PRESENT)
+};
+
+typedef struct {
+	double epsilon;		//stop if the log-likelihood improves by less than epsilon
+	int max_steps;		//maximal number of EM iterations, <= 0 uses the harness heuristic
+	int threads;		//workers of the expectation step over the sequences, <= 0 uses all cores
+	int time_parallel;	//nonzero: the threads split the forward step of each sequence in time
+				//instead of splitting the sequences (for few very long sequences)
+	int checkpoint;		//nonzero: keep alpha only every ~sqrt(T) steps and recompute the segments
+				//in the backward step (N*sqrt(T) instead of N*T memory, ignored with time_parallel)
+	int precision;		//BW_DOUBLE, BW_FLOAT or BW_MIXED (BW_FLOAT runs on one thread and ignores the three above,
+				//BW_MIXED ignores time_parallel and checkpoint)
+	int log_space;		//nonzero: forward and backward step on log probabilities with log-sum-exp instead of scaling,
+				//for near-deterministic models whose scaled alpha underflows (ignores time_parallel, checkpoint and precision)
+	int sparse;		//nonzero: keep only the nonzero transitions (CSR), O(nnz) instead of O(N^2) work per step,
+				//the zeros of the transition matrix stay zero (ignores the four above)
+	int banded;		//nonzero: keep only the band of diagonals holding the nonzero transitions (left-to-right models),
+				//O(N*bandwidth) work per step along the diagonals (ignores the five above)
+	int xi_block;		//> 0: sum xi over blocks of xi_block time steps as one matrix product alpha^T * (b * beta) per block
+				//instead of one rank-1 update per step, no ab table (scaled double precision only, ignored with
+				//time_parallel or checkpoint)
+	int ab;			//BW_AB_AUTO, BW_AB_FULL, BW_AB_PRESENT or BW_AB_ON_THE_FLY (BW_FLOAT always uses the full table)
+} bw_options;
+
+//fill options with the defaults of the harnesses (epsilon 1e-4, one thread, double precision, scaled, no xi blocks, BW_AB_AUTO)
+void bw_options_init(bw_options* const options);
+
+//allocate a model with N hidden states and K observables, all parameters zero
+//any N and K work, the kernels run on N and K rounded up to multiples of 4 (8 for BW_FLOAT)
+//returns NULL if the sizes are not positive or the memory runs out
+bw_model* bw_model_create(const int N, const int K);
+
+void bw_model_free(bw_model* const model);
+
+int bw_model_states(const bw_model* const model);
+
+int bw_model_observables(const bw_model* const model);
+
+//BW_AB_FULL, BW_AB_PRESENT or BW_AB_ON_THE_FLY: what the last training of the model used for the products of a and b,
+//BW_AB_AUTO before the first training
+int bw_model_ab(const bw_model* const model);
+
+//copy parameters into the model
+void bw_model_set(bw_model* const model, const double* const transitionMatrix, const double* const emissionMatrix, const double* const stateProb);
+
+//copy parameters out of the model
+void bw_model_get(const bw_model* const model, double* const transitionMatrix, double* const emissionMatrix, double* const stateProb);
+
+//reestimate the model on the observations y[0..T-1] (each in [0,K))
+//options may be NULL for the defaults
+//returns the number of EM steps done or -1 for invalid arguments or if the memory runs out
+int bw_train(bw_model* const model, const int* const y, const int T, const bw_options* const options);
+
+//reestimate the model on independent sequences y[i][0..T[i]-1], i = 0...sequences-1
+//the expected counts are pooled over all sequences before each update of the model
+//returns the number of EM steps done or -1 for invalid arguments (or a precision the sizes or the cpu do not support)
+//or if the memory for the buffers of the training runs out, the model is unchanged then
+int bw_train_multi(bw_model* const model, const int* const* const y, const int* const T, const int sequences, const bw_options* const options);
+
+//name of the kernel family in use ("scalar", "avx2" or "avx512"), picked once per process from the cpu
+//and overridable with the environment variable BW_KERNELS=scalar|avx2|avx512 (ignored if the cpu lacks it)
+const char* bw_kernels(void);
+
+//log-likelihood of the observations y[0..T-1] under the model or NAN for invalid arguments or if the memory runs out
+double bw_score(const bw_model* const model, const int* const y, const int T);
+
+#endif
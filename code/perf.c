@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <cpuid.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perf.h"
+
+const char* const counterNames[COUNTER_COUNT] = {"instructions", "hw_cycles", "l1d_misses", "llc_misses", "fp_ops"};
+
+static int tried = 0;
+static int leader = -1;
+static int members = 0;
+//position of every counter in the read of the group, -1 if it is not available
+static int slots[COUNTER_COUNT];
+
+//raw event of the retired double precision operations, 0 if we do not know the cpu
+static unsigned long long fpEvent(void){
+
+	unsigned int eax, ebx, ecx, edx;
+
+	if(!__get_cpuid(0, &eax, &ebx, &ecx, &edx)){
+		return 0;
+	}
+
+	//"GenuineIntel": FP_ARITH_INST_RETIRED (0xc7), scalar, 128, 256 and 512 bit double (umask 0x55)
+	if(ebx == 0x756e6547){
+		return 0x55c7;
+	}
+
+	//"AuthenticAMD": RETIRED_SSE_AVX_FLOPS (0x03), all of them (umask 0xff)
+	if(ebx == 0x68747541){
+		return 0xff03;
+	}
+
+	return 0;
+}
+
+static int openEvent(const unsigned int type, const unsigned long long config){
+
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+
+	//this thread on any cpu, the first counter that opens leads the group
+	return syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+
+int openCounters(void){
+
+	if(tried){
+		return members;
+	}
+
+	tried = 1;
+
+	const unsigned int types[COUNTER_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_RAW};
+	const unsigned long long configs[COUNTER_COUNT] = {
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES,
+		fpEvent()
+	};
+	int error = 0;
+
+	for(int c = 0; c < COUNTER_COUNT; c++){
+		slots[c] = -1;
+
+		if(types[c] == PERF_TYPE_RAW && configs[c] == 0){
+			continue;
+		}
+
+		int fd = openEvent(types[c], configs[c]);
+
+		if(fd < 0){
+			error = errno;
+			continue;
+		}
+
+		if(leader < 0){
+			leader = fd;
+		}
+
+		slots[c] = members++;
+	}
+
+	if(members < COUNTER_COUNT){
+		fprintf(stderr, "perf_event_open: %s, %d of %d hardware counters \n", error ? strerror(error) : "no fp event for this cpu", members, COUNTER_COUNT);
+	}
+
+	return members;
+}
+
+int counterAvailable(const int c){
+	openCounters();
+	return slots[c] >= 0;
+}
+
+void readCounters(unsigned long long* const values){
+
+	//number of counters and then their values
+	unsigned long long group[1 + COUNTER_COUNT] = {0};
+
+	if(openCounters() > 0 && read(leader, group, sizeof(group)) < 0){
+		group[0] = 0;
+	}
+
+	for(int c = 0; c < COUNTER_COUNT; c++){
+		values[c] = slots[c] >= 0 && slots[c] < (int)group[0] ? group[1 + slots[c]] : 0;
+	}
+}
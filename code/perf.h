@@ -0,0 +1,20 @@
+#ifndef PERF_FILE_
+#define PERF_FILE_
+
+//hardware counters of this thread through perf_event_open (linux), read around the phases of util.h with -DCOUNTERS
+//fp_ops: FP_ARITH_INST_RETIRED of all double widths on intel (an fma counts twice, a vector once), RETIRED_SSE_AVX_FLOPS on amd
+enum {COUNTER_INSTRUCTIONS, COUNTER_CYCLES, COUNTER_L1D_MISSES, COUNTER_LLC_MISSES, COUNTER_FP_OPS, COUNTER_COUNT};
+
+extern const char* const counterNames[COUNTER_COUNT];
+
+//opens the counters once as one group, returns how many the machine gives us
+//0 without a PMU (e.g. most virtual machines), the permission (kernel.perf_event_paranoid) or linux, the reason goes to stderr once
+int openCounters(void);
+
+//nonzero if counter c could be opened
+int counterAvailable(const int c);
+
+//current values of all counters (one read), counters that are not available stay 0
+void readCounters(unsigned long long* const values);
+
+#endif
@@ -4,6 +4,8 @@
 #include <math.h>
 #include <float.h>
 
+#include "util.h"
+
 
 void transpose(double* a, const int rows, const int cols){
 
@@ -96,22 +98,144 @@ void makeMatrix(const int dim1,const int dim2, double* const matrix){
 	}
 }
 
-int finished( const double* const ct, double* const l,const int N,const int T,const int EPSILON){
+//counting sort of the time steps by their observation
+//positions[start[v]...start[v+1]-1] are the t with observations[t] == v in increasing order
+//start has differentObservables+1 entries
+void symbolPositions(const int* const observations, const int differentObservables, const int T, int* const start, int* const positions){
+
+	for(int v = 0; v <= differentObservables; v++){
+		start[v] = 0;
+	}
+
+	for(int t = 0; t < T; t++){
+		start[observations[t]+1]++;
+	}
+
+	for(int v = 0; v < differentObservables; v++){
+		start[v+1] += start[v];
+	}
+
+	for(int t = 0; t < T; t++){
+		positions[start[observations[t]]++] = t;
+	}
+
+	//filling moved every start one symbol ahead
+	for(int v = differentObservables; v > 0; v--){
+		start[v] = start[v-1];
+	}
+
+	start[0] = 0;
+}
+
+//doubles rounded up to whole cache lines
+static size_t cacheLines(const size_t doubles){
+	return (doubles + 7) & ~(size_t)7;
+}
+
+//next buffer of count doubles out of the arena
+static double* carve(char** const next, const size_t count){
+	double* buffer = (double*) *next;
+	*next += cacheLines(count) * sizeof(double);
+	return buffer;
+}
+
+//size the arena of ctx for (N, K, T), a smaller or equal shape keeps the old arena
+//a new arena is written once so that its page faults do not land in the first iteration
+void makeContext(context* const ctx, const int N, const int K, const int T){
+
+	const size_t n = N;
+	const size_t k = K;
+	const size_t t = T;
+	const size_t size = (cacheLines(n*t) + 2*cacheLines(n) + cacheLines(k*n*n) + cacheLines(t+4)
+		+ 2*cacheLines(n) + cacheLines(n*n) + cacheLines(k*n)) * sizeof(double);
+
+	if(size > ctx->size){
+		free(ctx->arena);
+		ctx->arena = aligned_alloc(64, size);
+
+		if(ctx->arena == NULL){
+			printf("Not enough memory for the context \n");
+			exit(-1);
+		}
+
+		memset(ctx->arena, 0, size);
+		ctx->size = size;
+	}
+
+	ctx->N = N;
+	ctx->K = K;
+	ctx->T = T;
+
+	char* next = (char*) ctx->arena;
+	ctx->alpha = carve(&next, n*t);
+	ctx->beta = carve(&next, n);
+	ctx->beta_new = carve(&next, n);
+	ctx->ab = carve(&next, k*n*n);
+	ctx->ct = carve(&next, t+4);
+	ctx->gamma_T = carve(&next, n);
+	ctx->gamma_sum = carve(&next, n);
+	ctx->a_new = carve(&next, n*n);
+	ctx->b_new = carve(&next, k*n);
+}
+
+void freeContext(context* const ctx){
+	free(ctx->arena);
+	ctx->arena = NULL;
+	ctx->size = 0;
+}
+
+int finished(const double logLikelihood, double* const l, const double EPSILON){
 
 	double oldLogLikelihood=*l;
-	double newLogLikelihood = 0.0;
+	*l=logLikelihood;
+
+	return (logLikelihood-oldLogLikelihood)<EPSILON;
+}
 
-	for(int time = 0; time < T; time++){
-		newLogLikelihood -= log2(ct[time]);
+const char* const phaseNames[PHASE_COUNT] = {"transpose", "forward", "backward", "update", "finished"};
+
+void resetPhases(phase* const phases){
+	for(int p = 0; p < PHASE_COUNT; p++){
+		phases[p].cycles = 0;
+		phases[p].calls = 0;
+
+		for(int c = 0; c < COUNTER_COUNT; c++){
+			phases[p].counters[c] = 0;
+		}
 	}
-	
-	*l=newLogLikelihood;
+}
+
+//only with -DCOUNTERS, so that util.c still links without perf.c
+#ifdef COUNTERS
+void countPhase(phase* const ph){
 
-	return (newLogLikelihood-oldLogLikelihood)<EPSILON;
+	unsigned long long now[COUNTER_COUNT];
+	readCounters(now);
+
+	for(int c = 0; c < COUNTER_COUNT; c++){
+		ph->counters[c] += now[c] - ph->startCounters[c];
+	}
+}
+#endif
+
+void printPhases(const phase* const phases, const long steps){
+	for(int p = 0; p < PHASE_COUNT; p++){
+		if(phases[p].calls > 0){
+			printf("Phase %s: \t %lf cycles \t %lf calls per step \n", phaseNames[p], (double)phases[p].cycles/steps, (double)phases[p].calls/steps);
+
+#ifdef COUNTERS
+			for(int c = 0; c < COUNTER_COUNT; c++){
+				if(counterAvailable(c)){
+					printf("\t %s: %lf per step \n", counterNames[c], (double)phases[p].counters[c]/steps);
+				}
+			}
+#endif
+		}
+	}
 }
 
 //compare matrix a and matrix b with frobenius norm
-int similar(const double * const a, const double * const b , const int N, const int M, const int DELTA){
+int similar(const double * const a, const double * const b , const int N, const int M, const double DELTA){
 	
 	double sum=0.0;
 	double abs=0.0;
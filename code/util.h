@@ -1,6 +1,62 @@
 #ifndef UTIL_FILE_
 #define UTIL_FILE_
 
+#include <stddef.h>
+#include <math.h>
+
+#include "perf.h"
+
+//buffers of one training run of the shape (N, K, T), carved out of one 64 byte aligned arena
+//every buffer starts on its own cache line, ab is K x N x N and ct has T+4 entries for the vectorized loops
+//zero initialise it before the first makeContext, later calls reuse the arena as long as it is big enough
+typedef struct {
+	void* arena;
+	size_t size;
+	int N;
+	int K;
+	int T;
+	double* alpha;
+	double* beta;
+	double* beta_new;
+	double* ab;
+	double* ct;
+	double* gamma_T;
+	double* gamma_sum;
+	double* a_new;
+	double* b_new;
+} context;
+
+//phases of the EM steps for the cycle breakdown, all variants share them so that they can be compared
+//transpose: transposes of the transition and emission matrix and the ab table, update: the new model out of the sums
+enum {PHASE_TRANSPOSE, PHASE_FORWARD, PHASE_BACKWARD, PHASE_UPDATE, PHASE_FINISHED, PHASE_COUNT};
+
+typedef struct {
+	unsigned long long start;
+	unsigned long long cycles;
+	long calls;
+	unsigned long long startCounters[COUNTER_COUNT];
+	unsigned long long counters[COUNTER_COUNT];	//only with -DCOUNTERS, see perf.h
+} phase;
+
+extern const char* const phaseNames[PHASE_COUNT];
+
+//compiled in with -DPHASES (make $version PHASES=1), else they vanish
+//they need a phase array named phases in the file, the phases must not nest
+//plain rdtsc without the cpuid of start_tsc, which costs hundreds of cycles per call (thousands in a virtual machine)
+//-DCOUNTERS (make $version COUNTERS=1) reads the hardware counters as well, outside of the rdtsc so that the cycles do not get the read
+#if defined(PHASES) && defined(COUNTERS)
+#include <x86intrin.h>
+#define PHASE_START(p) do{ readCounters(phases[p].startCounters); phases[p].start = __rdtsc(); }while(0)
+#define PHASE_STOP(p) do{ phases[p].cycles += __rdtsc() - phases[p].start; phases[p].calls++; countPhase(&phases[p]); }while(0)
+#elif defined(PHASES)
+#include <x86intrin.h>
+#define PHASE_START(p) phases[p].start = __rdtsc()
+#define PHASE_STOP(p) do{ phases[p].cycles += __rdtsc() - phases[p].start; phases[p].calls++; }while(0)
+#else
+#define PHASE_START(p)
+#define PHASE_STOP(p)
+#endif
+
 inline void _flush_cache(volatile unsigned char* buf,const int BUFSIZE){
     for(unsigned int i = 0; i < BUFSIZE; ++i){
         buf[i] += i;
@@ -19,8 +75,36 @@ void makeProbabilities(double* const probabilities, const int options);
 
 void makeMatrix(const int dim1,const int dim2, double* const matrix);
 
-int finished(const double* const ct, double* const l,const int N,const int T,const int EPSILON);
+void symbolPositions(const int* const observations, const int differentObservables, const int T, int* const start, int* const positions);
+
+void makeContext(context* const ctx, const int N, const int K, const int T);
+
+void freeContext(context* const ctx);
+
+//the log-likelihood -sum log2(ct(t)) accumulated in the forward pass without a log2 per step:
+//the product of the ct(t) is kept as a mantissa in [0.5,1) (frexp) and the sum of the exponents
+//start with *mantissa = 1.0 and *exponent = 0
+static inline void scaleProduct(double* const mantissa, long* const exponent, const double ct){
+	int e;
+	*mantissa = frexp(*mantissa * ct, &e);
+	*exponent += e;
+}
+
+static inline double productLogLikelihood(const double mantissa, const long exponent){
+	return -(exponent + log2(mantissa));
+}
+
+//nonzero if logLikelihood improved on *l by less than EPSILON, *l becomes logLikelihood
+int finished(const double logLikelihood, double* const l, const double EPSILON);
+
+void resetPhases(phase* const phases);
+
+//adds the counters since startCounters to counters
+void countPhase(phase* const ph);
+
+//cycles and calls per EM step of every phase that was called (mean over all runs of steps EM steps together)
+void printPhases(const phase* const phases, const long steps);
 
-int similar(const double * const a, const double * const b , const int N, const int M, const int DELTA);
+int similar(const double * const a, const double * const b , const int N, const int M, const double DELTA);
 
 #endif